@@ -21,31 +21,118 @@ SOFTWARE.
 */
 
 #include "DisplayBase.h"
+#include "DisplayCharset.h"
+
+DisplayBase::DisplayBase(lcd_size_t type, bool bf, bool readable):
+    _type(type), _bf(bf), _readable(bf || readable) {
+    memset(_ddram, ' ', sizeof(_ddram));
+#if MBED_CONF_TEXTDISPLAY_FRAMES
+    memset(_frame, ' ', sizeof(_frame));
+#endif
+}
+
+DisplayBase::~DisplayBase() {
+    if (_idle_event) {
+        queue()->cancel(_idle_event);
+    }
+
+    if (_recover_event) {
+        queue()->cancel(_recover_event);
+    }
+
+    if (_scrub_event) {
+        queue()->cancel(_scrub_event);
+    }
+
+#if MBED_CONF_TEXTDISPLAY_POST
+    if (_drain_event) {
+        _post_queue->cancel(_drain_event);
+    }
+#endif
+
+#if MBED_CONF_TEXTDISPLAY_OP_QUEUE_SIZE
+    if (_ops_event) {
+        _queue->cancel(_ops_event);
+    }
+#endif
+
+#if MBED_CONF_TEXTDISPLAY_ANIMATIONS
+    for (auto &animation : _animations) {
+        if (animation.event) {
+            queue()->cancel(animation.event);
+        }
+    }
+#endif
 
-DisplayBase::DisplayBase(lcd_size_t type, bool bf):
-    _type(type), _bf(bf) {
+#if MBED_CONF_TEXTDISPLAY_MIRROR
+    if (_mirror_event) {
+        queue()->cancel(_mirror_event);
+    }
+#endif
 }
 
 bool DisplayBase::init(lcd_font_t font, lcd_char_t chars) {
-    // Function Set
-    for (auto i = 0; i < 2; i++) {
-        writeBits(0b0010); // 4-bit mode
+    ScopedLock<PlatformMutex> lock(_mutex);
+
+    _init_faults = _faults;
+    _initialized = false;
+    _font = font;
+    _chars = chars;
+    memset(_cgram_code, 0, sizeof(_cgram_code));
+    memset(_ddram, ' ', sizeof(_ddram));
+
+#if MBED_CONF_TEXTDISPLAY_POST
+    _post_queue = queue(); // post() may come from interrupt
+#endif
+
+    configure();
+    submit(OP_NOTIFY);
+
+    if (_scrub_interval.count() > 0) {
+        setScrubInterval(_scrub_interval);
     }
 
-    writeBits((rows() == 2 ? FN_2LINE : FN_1LINE) | chars | font);
+#if MBED_CONF_TEXTDISPLAY_OP_QUEUE_SIZE
+    return _queue ? true : _initialized;
+#else
+    return _initialized;
+#endif
+}
 
-    if (waitReady()) {
-        // Display ON/OFF Control
-        writeCommand(CMD_DISPLAY_CONTROL | CTRL_DISPLAY_OFF | CTRL_CURSOR_OFF | CTRL_BLINK_OFF);
+void DisplayBase::beginInit(Callback<void(bool)> done) {
+    ScopedLock<PlatformMutex> lock(_mutex);
+
+    if (!_queue) {
+        bind(mbed_event_queue());
+    }
+
+    _init_done = done;
+
+    auto since_boot = Kernel::Clock::now().time_since_epoch();
+    std::chrono::milliseconds power_on{MBED_CONF_TEXTDISPLAY_POWER_ON_DELAY};
+
+    if (since_boot < power_on) {
+        delay(power_on - since_boot);
+    }
+}
+
+bool DisplayBase::configure() {
+    uint32_t faults = _faults;
 
-        // Display Clear
-        cls();
+    invalidateCache();
+    functionSet();
+    submit(OP_READY);
 
-        // Return Home
-        home();
+    if (_faults == faults) {
+        // Display ON/OFF Control
+        setControl(CTRL_DISPLAY_OFF | CTRL_CURSOR_OFF | CTRL_BLINK_OFF);
+
+        // Display Clear, returns home as well
+        locate(0, 0);
+        clear();
 
         // Entry Mode Set
-        writeCommand(CMD_ENTRY_MODE_SET | ENTRY_MODE_INCREMENT | ENTRY_MODE_SHIFT_RIGHT);
+        setEntryMode(ENTRY_MODE_INCREMENT | ENTRY_MODE_SHIFT_RIGHT);
 
         return true;
     }
@@ -53,22 +140,168 @@ bool DisplayBase::init(lcd_font_t font, lcd_char_t chars) {
     return false;
 }
 
+void DisplayBase::functionSet() {
+    // Function Set
+    for (auto i = 0; i < 2; i++) {
+        writeBits(0b0010); // 4-bit mode
+    }
+
+    writeBits((rows() > 1 ? FN_2LINE : FN_1LINE) | _chars | _font);
+}
+
 void DisplayBase::character(uint8_t column, uint8_t row, uint8_t c) {
+    ScopedLock<PlatformMutex> lock(_mutex);
     uint8_t addr = getAddress(column, row);
-    writeCommand(addr);
+
+#if MBED_CONF_TEXTDISPLAY_FRAMES
+    if (_framing) {
+        uint8_t index = toIndex(addr & ~CMD_SET_DDRAM_ADDR);
+
+        if (index < DDRAM_SIZE && (!hasBackPage() || column < columns())) {
+            _frame[index] = c;
+            _priority[index] = _write_priority;
+        }
+
+        return;
+    }
+#endif
+
+    activity();
+
+    addr += pageOffset();
+    setAddress(addr);
     writeData(c);
+
+    uint8_t index = toIndex(addr & ~CMD_SET_DDRAM_ADDR);
+
+    if (index < DDRAM_SIZE) {
+        _ddram[index] = c;
+    }
+}
+
+void DisplayBase::writeRow(uint8_t row, const char *text, uint8_t length) {
+    ScopedLock<PlatformMutex> lock(_mutex);
+
+    if (row >= rows()) {
+        return;
+    }
+
+    if (!_framing) {
+        activity();
+    }
+
+    beginBatch();
+    writeLine(row, text, length);
+    endBatch();
+}
+
+void DisplayBase::writeScreen(const char *screen, uint8_t height, uint8_t width) {
+    ScopedLock<PlatformMutex> lock(_mutex);
+    // rows 0, 2 and 1, 3 of 20x4 follow each other in DDRAM
+    static const uint8_t order[4] = {0, 2, 1, 3};
+
+    if (!_framing) {
+        activity();
+    }
+
+    beginBatch();
+
+    for (auto i = 0; i < rows(); i++) {
+        uint8_t row = _type == SIZE_20x4 ? order[i] : i;
+        writeLine(row, row < height ? &screen[row * width] : "", width);
+    }
+
+    endBatch();
+}
+
+void DisplayBase::writeLine(uint8_t row, const char *text, uint8_t length) {
+    bool increment = _entry_mode & ENTRY_MODE_INCREMENT;
+    uint8_t width = columns();
+    uint8_t address = getAddress(0, row);
+    char line[40];
+    uint8_t column = 0;
+
+    for (; column < width && column < length && text[column]; column++) {
+        line[column] = text[column];
+    }
+
+    memset(&line[column], ' ', width - column);
+
+#if MBED_CONF_TEXTDISPLAY_FRAMES
+    if (_framing) {
+        for (column = 0; column < width; column++) {
+            uint8_t index = toIndex((address + column) & ~CMD_SET_DDRAM_ADDR);
+            _frame[index] = line[column];
+            _priority[index] = _write_priority;
+        }
+
+        return;
+    }
+#endif
+
+    address += pageOffset();
+    char *dst = &_ddram[toIndex(address & ~CMD_SET_DDRAM_ADDR)];
+    column = 0;
+
+    while (column < width) {
+        if (line[column] == dst[column]) {
+            column++;
+            continue;
+        }
+
+        setAddress(address + column);
+
+        // a single unchanged cell is rewritten, cheaper than an address command
+        do {
+            writeData(line[column]);
+            dst[column] = line[column];
+            column++;
+        } while (increment && column < width && (line[column] != dst[column] ||
+                                                 (column + 1 < width && line[column + 1] != dst[column + 1])));
+    }
 }
 
 void DisplayBase::cls() {
+    ScopedLock<PlatformMutex> lock(_mutex);
     locate(0, 0);
-    writeByte(CMD_CLEAR_DISPLAY);
+
+#if MBED_CONF_TEXTDISPLAY_FRAMES
+    if (_framing) {
+        memset(_frame, ' ', sizeof(_frame));
+        return;
+    }
+#endif
+
+    activity();
+
+    memset(_ddram, ' ', sizeof(_ddram));
+    clear();
+    setEntryMode(_entry_mode); // clear switched it to increment
+}
+
+void DisplayBase::clear() {
+    _page = 0;
+
+    if (_offline) {
+        return;
+    }
+
+    submit(OP_INSTRUCTION, CMD_CLEAR_DISPLAY);
+    _read_valid = false;
+
+    // address goes home, I/D is set to increment
+    _ac_cache = CMD_SET_DDRAM_ADDR;
+
+    if (_entry_cache != CACHE_UNKNOWN) {
+        _entry_cache |= ENTRY_MODE_INCREMENT;
+    }
 
     if (_bf) {
-        ThisThread::sleep_for(6ms);
-        waitReady();
+        delay(6ms);
+        submit(OP_READY);
 
     } else {
-        ThisThread::sleep_for(7ms); // minimum 6.2ms
+        delay(7ms); // minimum 6.2ms
     }
 }
 
@@ -78,47 +311,64 @@ void DisplayBase::locate(uint8_t column, uint8_t row) {
 }
 
 void DisplayBase::home() {
-    writeByte(CMD_RETURN_HOME);
+    ScopedLock<PlatformMutex> lock(_mutex);
+    activity();
+    returnHome();
+}
+
+void DisplayBase::returnHome() {
+    _page = 0; // display shift is reset as well
+
+    if (_offline) {
+        return;
+    }
+
+    submit(OP_INSTRUCTION, CMD_RETURN_HOME);
+    _read_valid = false;
+    _ac_cache = CMD_SET_DDRAM_ADDR;
 
     if (_bf) {
-        ThisThread::sleep_for(1ms);
-        waitReady();
+        delay(1ms);
+        submit(OP_READY);
 
     } else {
-        ThisThread::sleep_for(2ms); // minimum 1.52ms
+        delay(2ms); // minimum 1.52ms
     }
 }
 
 void DisplayBase::display(lcd_mode_t mode) {
+    ScopedLock<PlatformMutex> lock(_mutex);
+    activity();
+
     switch (mode) {
         case DISPLAY_ON :
             _control |= CTRL_DISPLAY_ON;
-            writeCommand(CMD_DISPLAY_CONTROL | _control);
+            setControl(_control);
             break;
 
         case DISPLAY_OFF:
             _control &= ~CTRL_DISPLAY_ON;
-            writeCommand(CMD_DISPLAY_CONTROL | _control);
+            setControl(_control);
             break;
 
         case CURSOR_ON:
             _control |= CTRL_CURSOR_ON;
-            writeCommand(CMD_DISPLAY_CONTROL | _control);
+            setControl(_control);
             break;
 
         case CURSOR_OFF:
             _control &= ~CTRL_CURSOR_ON;
-            writeCommand(CMD_DISPLAY_CONTROL | _control);
+            setControl(_control);
             break;
 
         case BLINK_ON:
             _control |= CTRL_BLINK_ON;
-            writeCommand(CMD_DISPLAY_CONTROL | _control);
+            setControl(_control);
             break;
 
         case BLINK_OFF:
             _control &= ~CTRL_BLINK_ON;
-            writeCommand(CMD_DISPLAY_CONTROL | _control);
+            setControl(_control);
             break;
 
         case SCROLL_LEFT:
@@ -131,22 +381,22 @@ void DisplayBase::display(lcd_mode_t mode) {
 
         case LEFT_TO_RIGHT:
             _entry_mode |= ENTRY_MODE_SHIFT_LEFT;
-            writeCommand(CMD_ENTRY_MODE_SET | _entry_mode);
+            setEntryMode(_entry_mode);
             break;
 
         case RIGHT_TO_LEFT:
             _entry_mode &= ~ENTRY_MODE_SHIFT_LEFT;
-            writeCommand(CMD_ENTRY_MODE_SET | _entry_mode);
+            setEntryMode(_entry_mode);
             break;
 
         case SCROLL_ON:
             _entry_mode |= ENTRY_MODE_INCREMENT;
-            writeCommand(CMD_ENTRY_MODE_SET | _entry_mode);
+            setEntryMode(_entry_mode);
             break;
 
         case SCROLL_OFF:
             _entry_mode &= ~ENTRY_MODE_INCREMENT;
-            writeCommand(CMD_ENTRY_MODE_SET | _entry_mode);
+            setEntryMode(_entry_mode);
             break;
     }
 }
@@ -156,175 +406,1527 @@ void DisplayBase::create(uint8_t location, const uint8_t charmap[]) {
         return;
     }
 
-    writeCommand(CMD_SET_CGRAM_ADDR | (location << 3));
+    ScopedLock<PlatformMutex> lock(_mutex);
+    activity();
 
-    for (auto i = 0; i < 8; i++) {
-        writeData(charmap[i]);
-    }
+    _cgram_user |= 1 << location;
+    _cgram_code[location] = 0;
+
+    writeGlyph(location, charmap);
 }
 
-int DisplayBase::_putc(int value) {
-    if (value == '\n' || value == '\r') {
-        _column = 0;
-        _row++;
+#if MBED_CONF_TEXTDISPLAY_ANIMATIONS
+void DisplayBase::animate(uint8_t location, const uint8_t (*frames)[8], uint8_t count,
+                          Kernel::Clock::duration_u32 interval) {
+    if (location > 7 || count == 0) {
+        return;
+    }
 
-        if (_row >= rows()) {
-            _row = 0;
-        }
+    ScopedLock<PlatformMutex> lock(_mutex);
+    animation_t &animation = _animations[location];
 
-    } else {
-        character(_column, _row, value);
-        _column++;
+    if (animation.event) {
+        queue()->cancel(animation.event);
+    }
 
-        if (_column >= 128 / rows()) {
-            _column = 0;
-            _row++;
+    animation.frames = frames;
+    animation.count = count;
+    animation.frame = 0;
 
-            if (_row >= rows()) {
-                _row = 0;
-            }
-        }
-    }
+    create(location, frames[0]);
 
-    return value;
+    animation.event = queue()->call_every(interval, callback(this, &DisplayBase::animationStep), location);
 }
 
-int DisplayBase::_getc() {
-    return -1;
+void DisplayBase::stopAnimation(uint8_t location) {
+    if (location > 7) {
+        return;
+    }
+
+    ScopedLock<PlatformMutex> lock(_mutex);
+    animation_t &animation = _animations[location];
+
+    if (animation.event) {
+        queue()->cancel(animation.event);
+        animation.event = 0;
+    }
 }
 
-uint8_t DisplayBase::getAddress(uint8_t column, uint8_t row) {
-    switch (_type) {
-        case SIZE_20x4:
-            switch (row) {
-                case 0:
-                    return 0x80 + column;
+void DisplayBase::animationStep(uint8_t location) {
+    ScopedLock<PlatformMutex> lock(_mutex);
+    animation_t &animation = _animations[location];
 
-                case 1:
-                    return 0xc0 + column;
+    // doesn't count as activity, a sleeping display stays asleep
+    if (_sleeping || !animation.event) {
+        return;
+    }
 
-                case 2:
-                    return 0x94 + column;
+    animation.frame = (animation.frame + 1) % animation.count;
 
-                case 3:
-                    return 0xd4 + column;
+    beginBatch();
+    writeGlyph(location, animation.frames[animation.frame]);
+    endBatch();
+}
 
-                default:
-                    return -1;
-            }
+#endif
 
-        default:
-            return 0x80 + (row * 0x40) + column;
+void DisplayBase::writeGlyph(uint8_t location, const uint8_t charmap[]) {
+    memcpy(&_cgram[location * 8], charmap, 8);
+
+#if MBED_CONF_TEXTDISPLAY_MIRROR
+    _mirror_cgram |= 1 << location;
+    scheduleMirror();
+#endif
+
+    setAddress(CMD_SET_CGRAM_ADDR | (location << 3));
+
+    for (auto i = 0; i < 8; i++) {
+        writeData(charmap[i]);
     }
 }
 
-uint8_t DisplayBase::columns() {
-    switch (_type) {
-        case SIZE_20x4:
-        case SIZE_20x2:
-        case SIZE_40x2:
-            return 20;
+#if MBED_CONF_TEXTDISPLAY_FRAMES
+void DisplayBase::beginFrame() {
+    ScopedLock<PlatformMutex> lock(_mutex);
 
-        case SIZE_8x2:
-            return 8;
+    if (_framing) {
+        return;
+    }
 
-        default:
-            return 16;
+    if (hasBackPage()) {
+        memset(_frame, ' ', sizeof(_frame));
+
+        for (auto line = 0; line < 2; line++) {
+            memcpy(&_frame[line * 40], &_ddram[line * 40 + pageOffset()], columns());
+        }
+
+    } else {
+        memcpy(_frame, _ddram, sizeof(_frame));
     }
+
+    memset(_priority, 0, sizeof(_priority));
+    _framing = true;
 }
 
-uint8_t DisplayBase::rows() {
-    switch (_type) {
-        case SIZE_20x4:
-            return 4;
+void DisplayBase::commit() {
+    ScopedLock<PlatformMutex> lock(_mutex);
 
-        default:
-            return 2;
+    if (!_framing) {
+        return;
     }
-}
 
-void DisplayBase::writeCommand(uint8_t command) {
-    rs(0);
-    writeByte(command);
+    _framing = false;
+    activity();
+    beginBatch();
 
-    waitReady();
-}
+    if (!hasBackPage()) {
+        flushFrame(40, 0);
 
-void DisplayBase::writeData(uint8_t data) {
-    rs(1);
-    writeByte(data);
+    } else { // compose in the hidden page, then flip
+        uint8_t back = _page ^ 1;
+        flushFrame(columns(), back * columns());
 
-    waitReady();
-}
+        if (back) {
+            for (auto i = 0; i < columns(); i++) {
+                writeCommand(CMD_CURSOR_SHIFT | DISPLAY_MOVE | MOVE_LEFT);
+            }
 
-void DisplayBase::writeBits(uint8_t value) {
-    rs(0);
+        } else {
+            returnHome();
+        }
 
-    rw(0);
+        _page = back;
+    }
 
-    dataWrite(value & 0b1111);
-    pulseEnable();
+    endBatch();
 }
 
-void DisplayBase::writeByte(uint8_t value) {
-    rw(0);
-
-    dataWrite(value >> 4); // send upper part first
-    pulseEnable();
-    dataWrite(value & 0b1111);
-    pulseEnable();
+void DisplayBase::setPriority(uint8_t priority) {
+    ScopedLock<PlatformMutex> lock(_mutex);
+    _write_priority = priority;
 }
 
-void DisplayBase::pulseEnable() {
-    en(0);
-    wait_us(2);
-    en(1);
-    wait_us(2);
-    en(0);
-    wait_us(40);
+uint8_t DisplayBase::frameTarget(uint8_t index) {
+    if (!hasBackPage()) {
+        return index;
+    }
+
+    if (index % 40 >= columns()) { // not part of the frame
+        return DDRAM_SIZE;
+    }
+
+    return index + pageOffset();
 }
 
-bool DisplayBase::waitReady() {
-    bool state = true;
+uint8_t DisplayBase::flush(uint16_t writes, std::chrono::microseconds time) {
+    ScopedLock<PlatformMutex> lock(_mutex);
+    uint32_t start = _writes;
+    uint8_t pending = 0;
+    Timer t;
 
-    if (_bf) {
-        Timer t;
+    if (!_framing) {
+        return 0;
+    }
 
-        dataInput();
-        rs(0);
-        rw(1);
+    activity();
+    beginBatch();
+    t.start();
 
-        t.start();
+    // one priority after another, cells of the same priority in address order so the runs need no address
+    for (int priority = 255; priority >= 0; priority--) {
+        int next = -1; // highest priority below this one still pending
 
-        while (1) {
-            if (t.elapsed_time().count() >= MBED_CONF_TEXTDISPLAY_TIMEOUT) {
-                state = false;
-                break;
+        for (auto i = 0; i < DDRAM_SIZE; i++) {
+            uint8_t target = frameTarget(i);
+
+            if (target >= DDRAM_SIZE || _frame[i] == _ddram[target]) {
+                continue;
             }
 
-            en(0);
-            wait_us(1);
-            en(1);
+            if (_priority[i] != priority) {
+                if (_priority[i] < priority && _priority[i] > next) {
+                    next = _priority[i];
+                }
 
-            wait_us(10);
+                continue;
+            }
 
-            bool busy = dataRead() & 0b1000;
+            uint8_t address = CMD_SET_DDRAM_ADDR | toAddress(target);
+            uint8_t cost = (address != _ac_cache) + 1;
 
-            en(0);
+            if (_writes - start + cost > writes || t.elapsed_time() >= time) {
+                pending++;
+                continue;
+            }
 
-            pulseEnable();
+            setAddress(address);
+            writeData(_frame[i]);
+            _ddram[target] = _frame[i];
+            _priority[i] = 0;
+        }
 
-            if (!busy) {
-                break;
+        if (pending || next < 0) {
+            break;
+        }
+
+        priority = next + 1;
+    }
+
+    endBatch();
+
+    // count the lower priorities left as well
+    pending = 0;
+
+    for (auto i = 0; i < DDRAM_SIZE; i++) {
+        uint8_t target = frameTarget(i);
+
+        if (target < DDRAM_SIZE && _frame[i] != _ddram[target]) {
+            pending++;
+        }
+    }
+
+    return pending;
+}
+
+void DisplayBase::flushFrame(uint8_t width, uint8_t offset) {
+    bool increment = _entry_mode & ENTRY_MODE_INCREMENT;
+
+    for (auto line = 0; line < 2; line++) {
+        char *src = &_frame[line * 40];
+        char *dst = &_ddram[line * 40 + offset];
+        uint8_t column = 0;
+
+        while (column < width) {
+            if (src[column] == dst[column]) {
+                column++;
+                continue;
             }
+
+            setAddress(CMD_SET_DDRAM_ADDR | toAddress(line * 40 + offset + column));
+
+            // address counter follows the data, no need to set it again within the run
+            do {
+                writeData(src[column]);
+                dst[column] = src[column];
+                column++;
+            } while (increment && column < width && src[column] != dst[column]);
         }
+    }
+}
+#endif
 
-        dataOutput();
-        rw(0);
+void DisplayBase::setUTF8(bool enable) {
+    ScopedLock<PlatformMutex> lock(_mutex);
+    _utf8 = enable;
+    _utf8_pending = 0;
+}
 
-    } else {
-        wait_us(40); // minimum 37us
+int DisplayBase::decode(uint8_t value) {
+    if ((value & 0xC0) == 0x80) { // continuation byte
+        if (_utf8_pending == 0) {
+            return -1;
+        }
+
+        _utf8_code = (_utf8_code << 6) | (value & 0x3F);
+
+        if (--_utf8_pending > 0) {
+            return -1;
+        }
+
+        return translate(_utf8_code);
     }
 
-    return state;
+    if ((value & 0xE0) == 0xC0) {
+        _utf8_code = value & 0x1F;
+        _utf8_pending = 1;
+
+    } else if ((value & 0xF0) == 0xE0) {
+        _utf8_code = value & 0x0F;
+        _utf8_pending = 2;
+
+    } else if ((value & 0xF8) == 0xF0) {
+        _utf8_code = value & 0x07;
+        _utf8_pending = 3;
+
+    } else {
+        _utf8_pending = 0;
+        return '?';
+    }
+
+    return -1;
+}
+
+uint8_t DisplayBase::translate(uint32_t code_point) {
+    int16_t code = DisplayCharset::romCode(_font, code_point);
+
+    if (code >= 0) {
+        return code;
+    }
+
+    return glyphCode(code_point);
+}
+
+uint8_t DisplayBase::glyphCode(uint32_t code_point) {
+    uint8_t charmap[8];
+    char fallback;
+
+    for (auto i = 0; i < 8; i++) {
+        if (!(_cgram_user & (1 << i)) && _cgram_code[i] == code_point) {
+            return i;
+        }
+    }
+
+    if (!DisplayCharset::glyph(code_point, charmap, &fallback)) {
+        return fallback;
+    }
+
+    // take a free location or a generated one which is not on the screen anymore
+    for (auto i = 0; i < 8; i++) {
+        uint8_t location = (_cgram_next + i) & 0b111;
+
+        if ((_cgram_user & (1 << location)) || (_cgram_code[location] && glyphShown(location))) {
+            continue;
+        }
+
+        writeGlyph(location, charmap);
+        _cgram_code[location] = code_point;
+        _cgram_next = (location + 1) & 0b111;
+
+        return location;
+    }
+
+    return fallback;
+}
+
+bool DisplayBase::glyphShown(uint8_t location) {
+    for (auto i = 0; i < DDRAM_SIZE; i++) {
+        uint8_t c = _ddram[i];
+
+        if (c < 16 && (c & 0b111) == location) { // 0x08-0x0F are mirrors of the CGRAM locations
+            return true;
+        }
+
+#if MBED_CONF_TEXTDISPLAY_FRAMES
+        c = _frame[i];
+
+        if (_framing && c < 16 && (c & 0b111) == location) {
+            return true;
+        }
+#endif
+    }
+
+    return false;
+}
+
+int DisplayBase::_putc(int value) {
+    int c = value;
+
+    if (_utf8 && (value & 0x80)) {
+        c = decode(value);
+
+        if (c < 0) { // wait for the rest of the sequence
+            return value;
+        }
+
+    } else {
+        _utf8_pending = 0;
+    }
+
+    if (c == '\n' || c == '\r') {
+        _column = 0;
+        _row++;
+
+        if (_row >= rows()) {
+            _row = 0;
+        }
+
+    } else {
+        character(_column, _row, c);
+        _column++;
+
+        if (_column >= 128 / rows()) {
+            _column = 0;
+            _row++;
+
+            if (_row >= rows()) {
+                _row = 0;
+            }
+        }
+    }
+
+    return value;
+}
+
+void DisplayBase::setIdleTimeout(Kernel::Clock::duration_u32 timeout) {
+    ScopedLock<PlatformMutex> lock(_mutex);
+
+    _idle_timeout = timeout;
+
+    if (_idle_event) { // armed for the old timeout
+        queue()->cancel(_idle_event);
+        _idle_event = 0;
+    }
+
+    activity();
+}
+
+void DisplayBase::activity() {
+    _last_activity = Kernel::Clock::now();
+
+    if (_sleeping) {
+        _sleeping = false;
+        powerSave(false);
+    }
+
+    if (_idle_timeout.count() > 0 && !_idle_event) {
+        _idle_event = queue()->call_in(_idle_timeout, callback(this, &DisplayBase::idleCheck));
+    }
+
+#if MBED_CONF_TEXTDISPLAY_MIRROR
+    scheduleMirror();
+#endif
+}
+
+void DisplayBase::idleCheck() {
+    ScopedLock<PlatformMutex> lock(_mutex);
+    _idle_event = 0;
+
+    if (_idle_timeout.count() == 0) {
+        return;
+    }
+
+    auto idle = Kernel::Clock::now() - _last_activity;
+
+    if (idle >= _idle_timeout) {
+        powerSave(true);
+        _sleeping = true;
+
+    } else { // written meanwhile, check again when it could expire
+        _idle_event = queue()->call_in(_idle_timeout - idle, callback(this, &DisplayBase::idleCheck));
+    }
+}
+
+void DisplayBase::powerSave(bool enable) {
+    if (enable) {
+        setControl(_control & ~CTRL_DISPLAY_ON);
+
+    } else {
+        setControl(_control);
+    }
+}
+
+uint32_t DisplayBase::faults() {
+    return _faults;
+}
+
+void DisplayBase::reportFault() {
+    _faults++;
+    invalidateCache();
+
+    if (!_initialized || _offline) {
+        return;
+    }
+
+    startRecovery();
+}
+
+bool DisplayBase::offline() {
+    return _offline || _recover_stage != RECOVER_DONE;
+}
+
+void DisplayBase::startRecovery() {
+    // stop talking to the display until it is initialized again, drop what is queued
+    _offline = true;
+#if MBED_CONF_TEXTDISPLAY_OP_QUEUE_SIZE
+    _ops_tail = _ops_head;
+#endif
+    _recover_stage = RECOVER_INIT;
+
+    if (!_recover_event && !_recovering) {
+        _recover_event = queue()->call(callback(this, &DisplayBase::recoverStep));
+    }
+}
+
+void DisplayBase::recoverStep() {
+    ScopedLock<PlatformMutex> lock(_mutex);
+    _recover_event = 0;
+    _recovering = true;
+    beginBatch();
+
+    switch (_recover_stage) {
+        case RECOVER_INIT: {
+            uint8_t page = _page; // clear() turns to page 0, the shown one is flipped in after redraw
+
+            _initialized = true; // faults take the display offline again, even if init() failed
+            _offline = false;
+            reset();
+            configure();
+            _page = page;
+
+            if (_offline) { // failed again
+                break;
+            }
+
+            setEntryMode(_entry_mode);
+
+            if (_sleeping) {
+                powerSave(true);
+
+            } else {
+                setControl(_control);
+            }
+
+            _recover_stage = RECOVER_CGRAM;
+            _recover_pos = 0;
+            break;
+        }
+
+        case RECOVER_CGRAM: // one character per step
+            while (_recover_pos < 8) {
+                uint8_t location = _recover_pos++;
+
+                if ((_cgram_user & (1 << location)) || _cgram_code[location]) {
+                    uint8_t charmap[8];
+                    memcpy(charmap, &_cgram[location * 8], 8);
+                    writeGlyph(location, charmap);
+                    break;
+                }
+            }
+
+            if (_recover_pos >= 8) {
+                _recover_stage = RECOVER_DDRAM;
+                _recover_pos = 0;
+            }
+
+            break;
+
+        case RECOVER_DDRAM: { // display was cleared, rewrite up to chunk of non-blank cells per step
+            uint8_t written = 0;
+
+            while (_recover_pos < DDRAM_SIZE && written < MBED_CONF_TEXTDISPLAY_RECOVERY_CHUNK) {
+                if (_ddram[_recover_pos] == ' ') {
+                    _recover_pos++;
+                    continue;
+                }
+
+                setAddress(CMD_SET_DDRAM_ADDR | toAddress(_recover_pos));
+
+                do {
+                    writeData(_ddram[_recover_pos++]);
+                    written++;
+                } while (_recover_pos < DDRAM_SIZE && _recover_pos != 40 && _ddram[_recover_pos] != ' ' &&
+                         written < MBED_CONF_TEXTDISPLAY_RECOVERY_CHUNK && (_entry_mode & ENTRY_MODE_INCREMENT));
+            }
+
+            if (_recover_pos < DDRAM_SIZE) {
+                break;
+            }
+
+            for (auto i = 0; i < pageOffset(); i++) {
+                writeCommand(CMD_CURSOR_SHIFT | DISPLAY_MOVE | MOVE_LEFT);
+            }
+
+            _recover_stage = RECOVER_DONE;
+            break;
+        }
+
+        default:
+            break;
+    }
+
+    endBatch();
+    _recovering = false;
+
+    if (_offline) { // give the display time to come back
+        _recover_stage = RECOVER_INIT;
+        _recover_event = queue()->call_in(std::chrono::milliseconds(MBED_CONF_TEXTDISPLAY_RECOVERY_RETRY),
+                                                     callback(this, &DisplayBase::recoverStep));
+
+    } else if (_recover_stage != RECOVER_DONE) {
+        _recover_event = queue()->call(callback(this, &DisplayBase::recoverStep));
+    }
+}
+
+uint8_t DisplayBase::scrub() {
+    ScopedLock<PlatformMutex> lock(_mutex);
+
+    return scrubRange(0, DDRAM_SIZE + sizeof(_cgram));
+}
+
+void DisplayBase::setScrubInterval(Kernel::Clock::duration_u32 interval) {
+    ScopedLock<PlatformMutex> lock(_mutex);
+    _scrub_interval = interval;
+
+    if (_scrub_event) {
+        queue()->cancel(_scrub_event);
+        _scrub_event = 0;
+    }
+
+    if (_scrub_interval.count() > 0 && _readable) {
+        _scrub_event = queue()->call_every(_scrub_interval, callback(this, &DisplayBase::scrubStep));
+    }
+}
+
+void DisplayBase::scrubStep() {
+    ScopedLock<PlatformMutex> lock(_mutex);
+
+    // nothing to compare against while redrawing, RAM of sleeping OLED may be unpowered
+    if (!_initialized || _offline || _recover_stage != RECOVER_DONE || _sleeping) {
+        return;
+    }
+
+    uint8_t to = _scrub_pos + MBED_CONF_TEXTDISPLAY_SCRUB_CHUNK;
+
+    if (to > DDRAM_SIZE + sizeof(_cgram)) {
+        to = DDRAM_SIZE + sizeof(_cgram);
+    }
+
+    scrubRange(_scrub_pos, to);
+    _scrub_pos = to < DDRAM_SIZE + sizeof(_cgram) ? to : 0;
+}
+
+uint8_t DisplayBase::scrubRange(uint8_t from, uint8_t to) {
+    uint8_t corrected = 0;
+
+    if (!_readable) {
+        return 0;
+    }
+
+    for (uint8_t pos = from; pos < to && !_offline; pos++) {
+        uint8_t address;
+        uint8_t expected;
+        uint8_t mask = 0xFF;
+
+        if (pos < DDRAM_SIZE) {
+            address = CMD_SET_DDRAM_ADDR | toAddress(pos);
+            expected = _ddram[pos];
+
+        } else {
+            uint8_t location = (pos - DDRAM_SIZE) / 8;
+
+            if (!(_cgram_user & (1 << location)) && !_cgram_code[location]) {
+                continue;
+            }
+
+            address = CMD_SET_CGRAM_ADDR | (pos - DDRAM_SIZE);
+            expected = _cgram[pos - DDRAM_SIZE];
+            mask = 0b11111; // only 5 pixels wide, bitmaps may have the upper bits set
+        }
+
+        setAddress(address);
+        int value = readData();
+
+        if (value < 0 || (value & mask) == (expected & mask) || _offline) {
+            continue;
+        }
+
+        setAddress(address);
+        writeData(expected);
+        corrected++;
+    }
+
+    return corrected;
+}
+
+bool DisplayBase::verifyBus() {
+    static const uint8_t pattern[8] = {0b10101, 0b01010, 0b11111, 0b00000, 0b10001, 0b01110, 0b11011, 0b00100};
+    uint32_t faults = _faults;
+    uint8_t location = 7;
+    bool match = true;
+
+    if (!_readable || !_initialized || _offline) {
+        return false;
+    }
+
+    for (auto i = 0; i < 8; i++) {
+        if (!glyphShown(i)) { // change can't be seen
+            location = i;
+            break;
+        }
+    }
+
+    // address set for each byte, entry mode may be decrementing
+    for (auto i = 0; i < 8; i++) {
+        setAddress(CMD_SET_CGRAM_ADDR | (location << 3) | i);
+        writeData(pattern[i]);
+    }
+
+    for (auto i = 0; i < 8 && !_offline; i++) {
+        setAddress(CMD_SET_CGRAM_ADDR | (location << 3) | i);
+
+        int value = readData();
+
+        if (value < 0 || (value & 0b11111) != pattern[i]) {
+            match = false;
+        }
+    }
+
+    for (auto i = 0; i < 8; i++) {
+        setAddress(CMD_SET_CGRAM_ADDR | (location << 3) | i);
+        writeData(_cgram[location * 8 + i]);
+    }
+
+    return match && _faults == faults;
+}
+
+#if MBED_CONF_TEXTDISPLAY_POST
+void DisplayBase::post(uint8_t column, uint8_t row, uint8_t c) {
+    if (column >= columns() || row >= rows()) {
+        return;
+    }
+
+    uint8_t pos = row * columns() + column;
+
+    // char first, the drain clears the bit before reading it so a newer one is never lost
+    _posted[pos] = c;
+    core_util_atomic_fetch_or_u32(&_posted_dirty[pos / 32], 1UL << (pos % 32));
+
+    if (!core_util_atomic_exchange_bool(&_drain_pending, true)) {
+        _drain_event = _post_queue ? _post_queue->call(callback(this, &DisplayBase::drainPosted)) : 0;
+
+        if (!_drain_event) { // queue full or not initialized yet, next post tries again
+            core_util_atomic_store_bool(&_drain_pending, false);
+        }
+    }
+}
+
+void DisplayBase::post(uint8_t column, uint8_t row, const char *text) {
+    while (*text && column < columns()) {
+        post(column++, row, *text++);
+    }
+}
+
+void DisplayBase::drainPosted() {
+    ScopedLock<PlatformMutex> lock(_mutex);
+
+    _drain_event = 0;
+    core_util_atomic_exchange_bool(&_drain_pending, false);
+    beginBatch();
+
+    for (uint8_t word = 0; word < sizeof(_posted_dirty) / sizeof(_posted_dirty[0]); word++) {
+        uint32_t dirty = core_util_atomic_exchange_u32(&_posted_dirty[word], 0);
+
+        for (uint8_t bit = 0; dirty; bit++, dirty >>= 1) {
+            if (dirty & 1) {
+                uint8_t pos = word * 32 + bit;
+                character(pos % columns(), pos / columns(), _posted[pos]);
+            }
+        }
+    }
+
+    endBatch();
+}
+#endif
+
+void DisplayBase::bind(EventQueue *queue) {
+    ScopedLock<PlatformMutex> lock(_mutex);
+
+    // scheduled events stay on their queue, their cancel() would go to the new one
+    MBED_ASSERT(!scheduled() || (queue ? queue : mbed_event_queue()) == this->queue());
+
+#if MBED_CONF_TEXTDISPLAY_OP_QUEUE_SIZE
+    if (_queue) {
+        flushOps();
+    }
+#endif
+
+    _queue = queue;
+
+#if MBED_CONF_TEXTDISPLAY_POST
+    if (_post_queue) {
+        _post_queue = this->queue();
+    }
+#endif
+}
+
+bool DisplayBase::scheduled() {
+#if MBED_CONF_TEXTDISPLAY_ANIMATIONS
+    for (auto &animation : _animations) {
+        if (animation.event) {
+            return true;
+        }
+    }
+#endif
+
+#if MBED_CONF_TEXTDISPLAY_POST
+    if (_drain_event) {
+        return true;
+    }
+#endif
+
+#if MBED_CONF_TEXTDISPLAY_MIRROR
+    if (_mirror_event) {
+        return true;
+    }
+#endif
+
+    return _idle_event || _recover_event || _scrub_event;
+}
+
+EventQueue *DisplayBase::queue() {
+    return _queue ? _queue : mbed_event_queue();
+}
+
+void DisplayBase::submit(uint8_t type, uint8_t value) {
+#if MBED_CONF_TEXTDISPLAY_OP_QUEUE_SIZE
+    if (!_queue || _ops_running) {
+        runOp(type, value);
+        return;
+    }
+
+    if (_offline && type != OP_NOTIFY) {
+        return;
+    }
+
+    uint16_t next = (_ops_head + 1) % MBED_CONF_TEXTDISPLAY_OP_QUEUE_SIZE;
+
+    if (next == _ops_tail) { // full, make room the blocking way
+        flushOps();
+    }
+
+    _ops[_ops_head].type = type;
+    _ops[_ops_head].value = value;
+    _ops_head = next;
+
+    if (!_ops_event) {
+        _ops_event = _queue->call(callback(this, &DisplayBase::runOps));
+    }
+#else
+    runOp(type, value);
+#endif
+}
+
+void DisplayBase::runOp(uint8_t type, uint8_t value) {
+    if (_offline && type != OP_NOTIFY) {
+        return;
+    }
+
+    switch (type) {
+        case OP_COMMAND:
+        case OP_DATA:
+        case OP_INSTRUCTION: {
+            _paced = beginBatch();
+            pinRs(type == OP_DATA);
+            writeByte(value);
+            bool kept = endBatch();
+            _paced = false;
+
+            if (type != OP_INSTRUCTION && (_bf || !kept) && !waitReady()) {
+                reportFault();
+            }
+
+            break;
+        }
+
+        case OP_BITS: {
+            _paced = beginBatch();
+            pinRs(0);
+
+            pinRw(0);
+
+            pinWrite(value & 0b1111);
+            pulseEnable();
+            bool kept = endBatch();
+
+            if (_paced && !kept) { // execution time was skipped in the pulse
+                wait_us(40);
+            }
+
+            _paced = false;
+            break;
+        }
+
+        case OP_READY:
+            flushBatch();
+
+            if (!waitReady()) {
+                reportFault();
+            }
+
+            break;
+
+        case OP_WAIT_US:
+            flushBatch();
+            wait_us(value);
+            break;
+
+        case OP_SLEEP_MS:
+            flushBatch();
+            ThisThread::sleep_for(std::chrono::milliseconds(value));
+            break;
+
+        case OP_NOTIFY:
+            _initialized = _faults == _init_faults;
+
+            if (!_initialized) { // display absent, keep trying so it comes up when plugged in
+                startRecovery();
+            }
+
+            if (_init_done) {
+                Callback<void(bool)> done = _init_done;
+                _init_done = nullptr;
+                done(_initialized);
+            }
+
+            break;
+    }
+}
+
+#if MBED_CONF_TEXTDISPLAY_OP_QUEUE_SIZE
+void DisplayBase::runOps() {
+    ScopedLock<PlatformMutex> lock(_mutex);
+    _ops_event = 0;
+    _ops_running = true;
+    beginBatch();
+
+    while (_ops_tail != _ops_head) {
+        op_t op = _ops[_ops_tail];
+        _ops_tail = (_ops_tail + 1) % MBED_CONF_TEXTDISPLAY_OP_QUEUE_SIZE;
+
+        // give the queue back for the long waits
+        if (op.type == OP_SLEEP_MS && !_offline) {
+            _ops_resume = Kernel::Clock::now() + std::chrono::milliseconds(op.value);
+            _ops_event = _queue->call_in(std::chrono::milliseconds(op.value), callback(this, &DisplayBase::runOps));
+            break;
+        }
+
+        runOp(op.type, op.value);
+    }
+
+    endBatch();
+    _ops_running = false;
+}
+
+void DisplayBase::flushOps() {
+    if (_ops_event) {
+        _queue->cancel(_ops_event);
+        _ops_event = 0;
+
+        ThisThread::sleep_until(_ops_resume); // finish the pending wait
+    }
+
+    _ops_running = true;
+    beginBatch();
+
+    while (_ops_tail != _ops_head) {
+        op_t op = _ops[_ops_tail];
+        _ops_tail = (_ops_tail + 1) % MBED_CONF_TEXTDISPLAY_OP_QUEUE_SIZE;
+
+        runOp(op.type, op.value);
+    }
+
+    endBatch();
+    _ops_running = false;
+}
+#endif
+
+void DisplayBase::lock() {
+    _mutex.lock();
+    beginBatch(); // printf() & co. write the whole string within
+}
+
+void DisplayBase::unlock() {
+    endBatch();
+    _mutex.unlock();
+}
+
+int DisplayBase::_getc() {
+    ScopedLock<PlatformMutex> lock(_mutex);
+
+    if (!_readable || _offline) {
+        return -1;
+    }
+
+    setAddress(getAddress(_column, _row) + pageOffset());
+    int c = readData();
+
+    if (c < 0 || _offline) {
+        return -1;
+    }
+
+    _column++;
+
+    if (_column >= 128 / rows()) {
+        _column = 0;
+        _row++;
+
+        if (_row >= rows()) {
+            _row = 0;
+        }
+    }
+
+    return c;
+}
+
+uint8_t DisplayBase::getAddress(uint8_t column, uint8_t row) {
+    switch (_type) {
+        case SIZE_20x4:
+            switch (row) {
+                case 0:
+                    return 0x80 + column;
+
+                case 1:
+                    return 0xc0 + column;
+
+                case 2:
+                    return 0x94 + column;
+
+                case 3:
+                    return 0xd4 + column;
+
+                default:
+                    return -1;
+            }
+
+        default:
+            return 0x80 + (row * 0x40) + column;
+    }
+}
+
+uint8_t DisplayBase::pageOffset() {
+    return _page * columns();
+}
+
+bool DisplayBase::hasBackPage() {
+#if MBED_CONF_TEXTDISPLAY_FRAMES && MBED_CONF_TEXTDISPLAY_BACK_PAGE
+    return rows() == 2 && _type != SIZE_40x2;
+#else
+    return false;
+#endif
+}
+
+uint8_t DisplayBase::toIndex(uint8_t address) {
+    uint8_t column = address & 0x3F;
+
+    if ((address & 0x80) || column >= 40) {
+        return DDRAM_SIZE;
+    }
+
+    return (address & 0x40 ? 40 : 0) + column;
+}
+
+uint8_t DisplayBase::toAddress(uint8_t index) {
+    return index < 40 ? index : 0x40 + index - 40;
+}
+
+uint8_t DisplayBase::columns() {
+    switch (_type) {
+        case SIZE_20x4:
+        case SIZE_20x2:
+        case SIZE_40x2:
+            return 20;
+
+        case SIZE_8x2:
+            return 8;
+
+        default:
+            return 16;
+    }
+}
+
+uint8_t DisplayBase::rows() {
+    switch (_type) {
+        case SIZE_20x4:
+            return 4;
+
+        default:
+            return 2;
+    }
+}
+
+void DisplayBase::writeCommand(uint8_t command) {
+    submit(OP_COMMAND, command);
+    _writes++;
+    _read_valid = command & (CMD_SET_DDRAM_ADDR | CMD_SET_CGRAM_ADDR);
+
+    if ((command & ~MOVE_RIGHT) == (CMD_CURSOR_SHIFT | DISPLAY_MOVE)) { // address counter stays
+        return;
+    }
+
+    if ((command & ~MOVE_RIGHT) == (CMD_CURSOR_SHIFT | CURSOR_MOVE) && (_ac_cache & CMD_SET_DDRAM_ADDR)) {
+        _ac_cache = CMD_SET_DDRAM_ADDR | nextAddress(_ac_cache & 0x7F, command & MOVE_RIGHT);
+        return;
+    }
+
+    _ac_cache = 0; // anything else may move it
+}
+
+void DisplayBase::writeData(uint8_t data) {
+    submit(OP_DATA, data);
+    _writes++;
+    _read_valid = false;
+    advanceAddress();
+}
+
+void DisplayBase::setAddress(uint8_t command) {
+    if (command == _ac_cache) {
+        return;
+    }
+
+    writeCommand(command);
+
+    // counter set outside of the lines has no defined successor
+    if (!(command & CMD_SET_DDRAM_ADDR) || toIndex(command & ~CMD_SET_DDRAM_ADDR) < DDRAM_SIZE) {
+        _ac_cache = command;
+    }
+}
+
+void DisplayBase::setControl(uint8_t control) {
+    if (control == _control_cache) {
+        return;
+    }
+
+    writeCommand(CMD_DISPLAY_CONTROL | control);
+    _control_cache = control;
+}
+
+void DisplayBase::setEntryMode(uint8_t mode) {
+    if (mode == _entry_cache) {
+        return;
+    }
+
+    writeCommand(CMD_ENTRY_MODE_SET | mode);
+    _entry_cache = mode;
+}
+
+void DisplayBase::advanceAddress() {
+    if (_ac_cache == 0) {
+        return;
+    }
+
+    if (_entry_cache == CACHE_UNKNOWN) {
+        _ac_cache = 0;
+        return;
+    }
+
+    bool increment = _entry_cache & ENTRY_MODE_INCREMENT;
+
+    if (!(_ac_cache & CMD_SET_DDRAM_ADDR)) { // CGRAM wraps within 64 bytes
+        _ac_cache = CMD_SET_CGRAM_ADDR | ((_ac_cache + (increment ? 1 : -1)) & 0x3F);
+        return;
+    }
+
+    _ac_cache = CMD_SET_DDRAM_ADDR | nextAddress(_ac_cache & 0x7F, increment);
+}
+
+uint8_t DisplayBase::nextAddress(uint8_t address, bool increment) {
+    // 2-line mode, the lines are 0x00-0x27 and 0x40-0x67, the counter jumps between them
+    if (increment) {
+        return address == 0x27 ? 0x40 : address == 0x67 ? 0 : address + 1;
+    }
+
+    return address == 0x40 ? 0x27 : address == 0 ? 0x67 : address - 1;
+}
+
+void DisplayBase::invalidateCache() {
+    _ac_cache = 0;
+    _read_valid = false;
+    _control_cache = CACHE_UNKNOWN;
+    _entry_cache = CACHE_UNKNOWN;
+}
+
+void DisplayBase::writeBits(uint8_t value) {
+    submit(OP_BITS, value);
+}
+
+void DisplayBase::delay(std::chrono::microseconds time) {
+    if (time.count() <= 255) { // fits the op value, longer waits sleep whole milliseconds
+        submit(OP_WAIT_US, time.count());
+        return;
+    }
+
+    auto ms = (time.count() + 999) / 1000; // round up
+
+    while (ms > 0) {
+        uint8_t step = ms > 255 ? 255 : ms;
+        submit(OP_SLEEP_MS, step);
+        ms -= step;
+    }
+}
+
+void DisplayBase::writeByte(uint8_t value) {
+    if (_offline) {
+        return;
+    }
+
+    pinRw(0);
+
+    pinWrite(value >> 4); // send upper part first
+    pulseEnable();
+    pinWrite(value & 0b1111);
+    pulseEnable();
+}
+
+int DisplayBase::readData() {
+    // after a write the data register holds the written byte, an address command reloads it
+    if (!_read_valid) {
+        uint8_t address = _ac_cache;
+
+        if (!address) {
+            return -1;
+        }
+
+        writeCommand(address);
+        _ac_cache = address;
+    }
+
+#if MBED_CONF_TEXTDISPLAY_OP_QUEUE_SIZE
+    if (_queue && !_ops_running) { // writes before have to be done
+        flushOps();
+    }
+#endif
+
+    if (_offline) {
+        return 0;
+    }
+
+    pinRs(1);
+    uint8_t data = readByte();
+    advanceAddress();
+
+    if (!waitReady()) {
+        reportFault();
+    }
+
+    return data;
+}
+
+uint8_t DisplayBase::readByte() {
+    uint8_t value;
+
+    dataInput();
+    pinRw(1);
+
+    pinEn(1);
+    wait_us(1); // data output delay
+    value = (pinRead() & 0b1111) << 4; // upper part first
+    pinEn(0);
+    wait_us(1);
+
+    pinEn(1);
+    wait_us(1);
+    value |= pinRead() & 0b1111;
+    pinEn(0);
+
+    dataOutput();
+    pinRw(0);
+
+    return value;
+}
+
+bool DisplayBase::beginBatch() {
+    return false;
+}
+
+bool DisplayBase::endBatch() {
+    return false;
+}
+
+void DisplayBase::flushBatch() {
+}
+
+void DisplayBase::pulseEnable() {
+    if (_paced) { // states are sent later, each of them takes longer than the minimal pulse
+        pinEn(0);
+        pinEn(1);
+        pinEn(0);
+        return;
+    }
+
+    pinEn(0);
+    wait_us(2);
+    pinEn(1);
+    wait_us(2);
+    pinEn(0);
+    wait_us(40);
+}
+
+bool DisplayBase::waitReady() {
+    bool state = true;
+
+    if (_bf) {
+        Timer t;
+
+        dataInput();
+        pinRs(0);
+        pinRw(1);
+
+        t.start();
+
+        while (1) {
+            if (t.elapsed_time().count() >= MBED_CONF_TEXTDISPLAY_TIMEOUT) {
+                state = false;
+                break;
+            }
+
+            pinEn(0);
+            wait_us(1);
+            pinEn(1);
+
+            wait_us(10);
+
+            bool busy = pinRead() & 0b1000;
+
+            pinEn(0);
+
+            pulseEnable();
+
+            if (!busy) {
+                break;
+            }
+        }
+
+        dataOutput();
+        pinRw(0);
+
+    } else {
+        wait_us(40); // minimum 37us
+    }
+
+    return state;
+}
+
+void DisplayBase::pinRs(bool state) {
+    record(TRACE_RS, state);
+    rs(state);
+}
+
+void DisplayBase::pinRw(bool state) {
+    record(TRACE_RW, state);
+    rw(state);
+}
+
+void DisplayBase::pinEn(bool state) {
+    record(TRACE_EN, state);
+    en(state);
+}
+
+void DisplayBase::pinWrite(uint8_t pins) {
+    record(TRACE_DATA, pins);
+    dataWrite(pins);
+}
+
+uint8_t DisplayBase::pinRead() {
+    uint8_t pins = dataRead();
+    record(TRACE_READ, pins);
+
+    return pins;
+}
+
+void DisplayBase::record(trace_event_t event, uint8_t value) {
+#if MBED_CONF_TEXTDISPLAY_TRACE
+    if (!_trace_file) {
+        return;
+    }
+
+    if (sizeof(_trace) - _trace_len < 7) { // event, value and up to 5 bytes of time
+        flushTrace();
+    }
+
+    uint32_t time = _trace_timer.elapsed_time().count();
+    _trace_timer.reset();
+
+    if (event == TRACE_BYTE) {
+        _trace[_trace_len++] = event << 4;
+        _trace[_trace_len++] = value;
+
+    } else {
+        _trace[_trace_len++] = event << 4 | (value & 0b1111);
+    }
+
+    // 7 bits per byte, MSB set if more follow
+    do {
+        _trace[_trace_len++] = (time & 0x7F) | (time > 0x7F ? 0x80 : 0);
+        time >>= 7;
+    } while (time);
+#endif
+}
+
+#if MBED_CONF_TEXTDISPLAY_TRACE
+void DisplayBase::setTrace(FileHandle *file) {
+    ScopedLock<PlatformMutex> lock(_mutex);
+
+    if (_trace_file) {
+        flushTrace();
+    }
+
+    _trace_file = file;
+
+    if (_trace_file) {
+        // magic, version, panel size, busy flag
+        const uint8_t header[] = {'T', 'D', 'T', 1, (uint8_t)_type, _bf};
+        _trace_file->write(header, sizeof(header));
+
+        _trace_timer.reset();
+        _trace_timer.start();
+
+    } else {
+        _trace_timer.stop();
+    }
+}
+
+void DisplayBase::flushTrace() {
+    _trace_file->write(_trace, _trace_len);
+    _trace_len = 0;
+    _trace_timer.reset(); // time spent writing is not display traffic
+}
+#endif
+
+#if MBED_CONF_TEXTDISPLAY_MIRROR
+void DisplayBase::setMirror(FileHandle *file, Kernel::Clock::duration_u32 interval) {
+    ScopedLock<PlatformMutex> lock(_mutex);
+
+    _mirror_file = file;
+    _mirror_interval = interval;
+
+    if (!_mirror_file) {
+        if (_mirror_event) {
+            queue()->cancel(_mirror_event);
+            _mirror_event = 0;
+        }
+
+        return;
+    }
+
+    // magic, version, panel geometry, then everything is sent as changed
+    const uint8_t header[] = {'T', 'D', 'M', 1, columns(), rows()};
+    _mirror_file->write(header, sizeof(header));
+
+    memset(_mirror, 0, sizeof(_mirror));
+    _mirror_cgram = _cgram_user;
+
+    for (auto i = 0; i < 8; i++) {
+        if (_cgram_code[i]) {
+            _mirror_cgram |= 1 << i;
+        }
+    }
+
+    _mirror_last = Kernel::Clock::now() - _mirror_interval;
+    scheduleMirror();
+}
+
+void DisplayBase::scheduleMirror() {
+    if (!_mirror_file || _mirror_event) {
+        return;
+    }
+
+    auto since = Kernel::Clock::now() - _mirror_last;
+
+    if (since >= _mirror_interval) {
+        _mirror_event = queue()->call(callback(this, &DisplayBase::mirrorStep));
+
+    } else { // collect the changes until the interval passes
+        _mirror_event = queue()->call_in(_mirror_interval - since, callback(this, &DisplayBase::mirrorStep));
+    }
+}
+
+void DisplayBase::mirrorStep() {
+    ScopedLock<PlatformMutex> lock(_mutex);
+    uint8_t record[2 + 40];
+    uint8_t len = 0;
+    bool changed = false;
+
+    _mirror_event = 0;
+    _mirror_last = Kernel::Clock::now();
+
+    if (!_mirror_file) {
+        return;
+    }
+
+    for (auto location = 0; location < 8; location++) {
+        if (_mirror_cgram & (1 << location)) {
+            record[0] = MIRROR_GLYPH | location;
+            memcpy(&record[1], &_cgram[location * 8], 8);
+            _mirror_file->write(record, 9);
+            changed = true;
+        }
+    }
+
+    _mirror_cgram = 0;
+
+    for (uint8_t row = 0; row < rows(); row++) {
+        uint8_t column = 0;
+
+        while (column < columns()) {
+            uint8_t pos = row * columns() + column;
+            char c = _ddram[toIndex((getAddress(column, row) + pageOffset()) & ~CMD_SET_DDRAM_ADDR)];
+
+            if (c == _mirror[pos]) {
+                if (len > 0 && column - (record[0] + len - row * columns()) >= 2) { // gap costs more than a new run
+                    _mirror_file->write(record, 2 + len);
+                    len = 0;
+                }
+
+                column++;
+                continue;
+            }
+
+            if (len == 0) {
+                record[0] = pos;
+
+            } else { // fill the short gap
+                while (record[0] + len < pos) {
+                    record[2 + len] = _mirror[record[0] + len];
+                    len++;
+                }
+            }
+
+            record[2 + len++] = c;
+            record[1] = len;
+            _mirror[pos] = c;
+            changed = true;
+            column++;
+        }
+
+        if (len > 0) { // runs don't cross rows
+            _mirror_file->write(record, 2 + len);
+            len = 0;
+        }
+    }
+
+    if (changed) {
+        const uint8_t end = MIRROR_END;
+        _mirror_file->write(&end, 1);
+    }
 }
+#endif
@@ -25,8 +25,11 @@ SOFTWARE.
 
 #include "mbed.h"
 #include "Stream.h"
+#include "platform/ScopedLock.h"
 
 class DisplayBase : public Stream {
+    friend class DisplayList; // draws within lock()
+
   public:
     enum lcd_size_t {
         SIZE_8x2,  // 8x2 panel
@@ -68,8 +71,15 @@ class DisplayBase : public Stream {
 
      * @param size  Panel size
      * @param bf  Set to true if busy flag should be used
+     * @param readable  Set to true if R/W pin is connected (implied by bf)
      */
-    DisplayBase(lcd_size_t size, bool bf);
+    DisplayBase(lcd_size_t size, bool bf, bool readable = false);
+
+    /**
+     * @brief Destructor
+     *
+     */
+    ~DisplayBase();
 
     /**
      * @brief Clear the screen and locate to 0,0
@@ -107,6 +117,27 @@ class DisplayBase : public Stream {
      */
     void create(uint8_t location, const uint8_t charmap[]);
 
+#if MBED_CONF_TEXTDISPLAY_ANIMATIONS
+    /**
+     * @brief Animate a user defined char by rewriting its bitmap on a timer
+     * Every cell showing the location changes at once without touching DDRAM,
+     * ie. frames {glyph, blank} blink a whole field for 9 writes per phase
+     *
+     * @param location index 0-7
+     * @param frames bitmaps, has to stay valid while animating
+     * @param count number of frames
+     * @param interval time of one frame
+     */
+    void animate(uint8_t location, const uint8_t (*frames)[8], uint8_t count, Kernel::Clock::duration_u32 interval);
+
+    /**
+     * @brief Stop the animation, the current frame stays
+     *
+     * @param location index 0-7
+     */
+    void stopAnimation(uint8_t location);
+#endif
+
     /**
      * @brief Writes a single char to a given position, usefull for UDC
      *
@@ -116,6 +147,37 @@ class DisplayBase : public Stream {
      */
     void character(uint8_t column, uint8_t row, uint8_t c);
 
+    /**
+     * @brief Write a whole row at once
+     * Only the changed cells are sent, in runs with a single address command each.
+     * Characters are raw codes without UTF-8 translation, use 8 for CGRAM location 0
+     *
+     * @param row
+     * @param text characters up to '\0' or length, the rest of the row is cleared
+     * @param length maximum number of characters taken
+     */
+    void writeRow(uint8_t row, const char *text, uint8_t length = 255);
+
+    /**
+     * @brief Write a whole screen at once from an app buffer, ie. char screen[4][20]
+     * Rows are sent in DDRAM order, the runs continue across the 20x4 interleaved rows
+     *
+     * @param screen rows, see writeRow()
+     */
+    template<size_t R, size_t C>
+    void writeScreen(const char (&screen)[R][C]) {
+        writeScreen(&screen[0][0], R, C);
+    }
+
+    /**
+     * @brief Write a whole screen at once
+     *
+     * @param screen rows stored one after another, see writeRow()
+     * @param height number of rows in the buffer, missing rows are cleared
+     * @param width size of one row in the buffer
+     */
+    void writeScreen(const char *screen, uint8_t height, uint8_t width);
+
     /**
      * @brief Get number of rows
      *
@@ -130,7 +192,152 @@ class DisplayBase : public Stream {
      */
     uint8_t columns();
 
+#if MBED_CONF_TEXTDISPLAY_FRAMES
+    /**
+     * @brief Start composing the next screen off-screen
+     * All following writes (printf, character, cls) go to a back buffer which
+     * starts as a copy of the current screen, nothing is sent to the display
+     *
+     */
+    void beginFrame();
+
+    /**
+     * @brief Show the composed screen
+     * Only the cells that differ are written, with back-page in mbed_lib.json on 2-line
+     * panels narrower than the DDRAM the frame is written to the hidden half and flipped in
+     *
+     */
+    void commit();
+
+    /**
+     * @brief Priority of the following writes into the frame, see flush()
+     *
+     * @param priority 0 (default) is the lowest
+     */
+    void setPriority(uint8_t priority);
+
+    /**
+     * @brief Write part of the composed screen to the visible page and keep composing
+     * Changed cells are sent from the highest priority, the rest stays pending
+     * for the next call. When bound to a queue, time counts queueing only
+     *
+     * @param writes Budget of commands and characters
+     * @param time Budget of time
+     *
+     * @return number of cells still pending
+     */
+    uint8_t flush(uint16_t writes, std::chrono::microseconds time = std::chrono::microseconds::max());
+#endif
+
+    /**
+     * @brief Decode printed text as UTF-8
+     * Characters are translated to the font table, the ones missing in ROM
+     * are generated in free CGRAM locations (the ones not used by create())
+     *
+     * @param enable
+     */
+    void setUTF8(bool enable);
+
+    /**
+     * @brief Turn the display off after a period without changes
+     * It is turned back on by the next write, the app doesn't need to re-init
+     *
+     * @param timeout idle time, 0 to disable
+     */
+    void setIdleTimeout(Kernel::Clock::duration_u32 timeout);
+
+    /**
+     * @brief Get number of bus errors and timeouts
+     * Display is initialized again and redrawn in the background after each of them
+     *
+     * @return error count
+     */
+    uint32_t faults();
+
+    /**
+     * @brief Read the display RAM back and rewrite the characters that don't match
+     * Needs R/W pin, nothing is checked without it
+     *
+     * @return number of corrected bytes
+     */
+    uint8_t scrub();
+
+    /**
+     * @brief Check the display RAM periodically in the background
+     * Only a part of it is checked on each run, see scrub-chunk in mbed_lib.json
+     *
+     * @param interval time between runs, 0 to disable
+     */
+    void setScrubInterval(Kernel::Clock::duration_u32 interval);
+
+#if MBED_CONF_TEXTDISPLAY_POST
+    /**
+     * @brief Write a single char from interrupt
+     * It is written later from the event queue, only the last char posted
+     * to a position is written. Nothing is written before init()
+     *
+     * @param column
+     * @param row
+     * @param c character
+     */
+    void post(uint8_t column, uint8_t row, uint8_t c);
+
+    /**
+     * @brief Write a text from interrupt, cut at the end of the row
+     *
+     * @param column
+     * @param row
+     * @param text null terminated string
+     */
+    void post(uint8_t column, uint8_t row, const char *text);
+#endif
+
+    /**
+     * @brief Let an event queue drive the display instead of blocking the caller
+     * Writes are buffered and sent when the queue is dispatched, delays become
+     * timed events. Reading back still blocks until the buffer is sent.
+     * With op-queue-size 0 in mbed_lib.json writes block, only the background work moves.
+     * Call before init(), all background work moves to the queue as well.
+     * init() returns before anything is sent, use initAsync() to get the result.
+     * The queue can't change while background work is scheduled (idle timeout, scrub,
+     * animations, post(), backlight dimming), bind before starting it
+     *
+     * @param queue EventQueue to use, nullptr to block the caller again
+     */
+    void bind(EventQueue *queue);
+
+#if MBED_CONF_TEXTDISPLAY_TRACE
+    /**
+     * @brief Record every pin change with its time to a binary trace
+     * Replay it on the host with tools/trace_replay.cpp
+     *
+     * @param file where to write, nullptr to stop recording and flush the rest
+     */
+    void setTrace(FileHandle *file);
+#endif
+
+#if MBED_CONF_TEXTDISPLAY_MIRROR
+    /**
+     * @brief Send the screen changes to a file (ie. BufferedSerial), see tools/mirror_decode.cpp
+     * The whole screen and CGRAM go first, then the changed cells and glyphs,
+     * changes within the interval are sent together
+     *
+     * @param file where to write, nullptr to stop
+     * @param interval minimal time between the updates
+     */
+    void setMirror(FileHandle *file, Kernel::Clock::duration_u32 interval = 100ms);
+#endif
+
   protected:
+    enum trace_event_t { // high nibble of the event byte, microseconds since the previous event follow
+        TRACE_DATA, // data pins, low nibble
+        TRACE_EN,
+        TRACE_RS,
+        TRACE_RW,
+        TRACE_READ, // data pins read, low nibble
+        TRACE_BYTE  // whole byte on native serial interface, value byte follows
+    };
+
     enum lcd_command_t {
         CMD_CLEAR_DISPLAY   = 0b1,
         CMD_RETURN_HOME     = 0b10,
@@ -172,6 +379,11 @@ class DisplayBase : public Stream {
         MOVE_LEFT    = 0,
     };
 
+    enum ws0010_mode_t { // shares the command with cursor shift
+        MODE_CHARACTER = 0b0011, // G/C
+        MODE_POWER_ON  = 0b0100, // PWR
+    };
+
     /**
      * @brief Initialize the display
      *
@@ -183,7 +395,16 @@ class DisplayBase : public Stream {
     bool init(lcd_font_t font, lcd_char_t chars);
 
     /**
-     * @brief Write command (with wait or busy flag)
+     * @brief Queue the initialization that follows (reset() and init())
+     * Binds to the shared event queue if not bound yet and waits until the
+     * controller is powered up
+     *
+     * @param done called from the queue with the result of init
+     */
+    void beginInit(Callback<void(bool)> done);
+
+    /**
+     * @brief Write command (with wait or busy flag), address counter is considered unknown afterwards
      *
      * @param command
      */
@@ -204,11 +425,39 @@ class DisplayBase : public Stream {
     void writeBits(uint8_t value);
 
     /**
-     * @brief Write byte
+     * @brief Write byte, as two nibbles unless the interface takes whole bytes
      *
      * @param value
      */
-    void writeByte(uint8_t value);
+    virtual void writeByte(uint8_t value);
+
+    /**
+     * @brief Switch to 4-bit mode and set the lines and font, controllers
+     * with native serial interface send their own sequence
+     *
+     */
+    virtual void functionSet();
+
+    /**
+     * @brief Wait in order with the writes, scheduled as an event when bound to a queue
+     *
+     * @param time
+     */
+    void delay(std::chrono::microseconds time);
+
+    /**
+     * @brief Read data at the address counter (with wait or busy flag)
+     *
+     * @return data, -1 if the register holds a written byte and the counter position is unknown
+     */
+    int readData();
+
+    /**
+     * @brief Read byte
+     *
+     * @return value
+     */
+    uint8_t readByte();
 
     /**
      * @brief
@@ -217,9 +466,106 @@ class DisplayBase : public Stream {
      */
     bool waitReady();
 
+    /**
+     * @brief Note a change, wakes up the display if sleeping
+     *
+     */
+    void activity();
+
+    /**
+     * @brief Turn the display off/on when idle
+     *
+     * @param enable true to sleep, false to wake up
+     */
+    virtual void powerSave(bool enable);
+
+    /**
+     * @brief Note a bus error or timeout, starts recovery
+     *
+     */
+    void reportFault();
+
+    /**
+     * @brief Check if the display doesn't respond or is being initialized again
+     * Backends skip their own traffic (ie. backlight) meanwhile
+     *
+     * @return true if offline
+     */
+    bool offline();
+
+    /**
+     * @brief Write a test pattern into CGRAM and read it back, the location is restored after
+     * A location not shown on the screen is used, needs R/W pin
+     *
+     * @return true if the pattern matched and no fault occurred, false otherwise
+     */
+    bool verifyBus();
+
+    /**
+     * @brief Bring the controller into 4-bit mode, sequence before function set
+     *
+     */
+    virtual void reset() = 0;
+
+    /**
+     * @brief Pin changes of one bus operation follow, the backend can buffer them
+     * Batches nest, the outer ones span a whole string or frame
+     *
+     * @return true if the buffered changes are sent spaced by the backend, false otherwise
+     */
+    virtual bool beginBatch();
+
+    /**
+     * @brief End of the batch, send the buffered pin changes or keep them for the outer one
+     *
+     * @return true if kept and the backend spaces the next operation by the execution time itself
+     */
+    virtual bool endBatch();
+
+    /**
+     * @brief Send the kept pin changes now, a wait follows
+     *
+     */
+    virtual void flushBatch();
+
+    /**
+     * @brief Add an event to the trace, does nothing unless recording
+     *
+     * @param event
+     * @param value
+     */
+    void record(trace_event_t event, uint8_t value);
+
+    /**
+     * @brief Get the queue running the background work
+     *
+     * @return queue passed to bind(), shared event queue otherwise
+     */
+    EventQueue *queue();
+
+    /**
+     * @brief Check if background work is scheduled on the queue
+     *
+     * @return true if an event is pending
+     */
+    virtual bool scheduled();
+
+    /**
+     * @brief Get the DDRAM address the counter moves to in 2-line mode
+     *
+     * @param address
+     * @param increment
+     * @return next address
+     */
+    static uint8_t nextAddress(uint8_t address, bool increment);
+
+    void lock() override;
+    void unlock() override;
+
   private:
     const lcd_size_t _type = SIZE_16x2;
     bool _bf = false;
+    bool _readable = false;
 
     uint8_t _control = CTRL_DISPLAY_OFF | CTRL_CURSOR_OFF | CTRL_BLINK_OFF;
     uint8_t _entry_mode = ENTRY_MODE_INCREMENT | ENTRY_MODE_SHIFT_RIGHT;
@@ -227,12 +573,187 @@ class DisplayBase : public Stream {
     uint8_t _column = 0;
     uint8_t _row = 0;
 
+    static const uint8_t DDRAM_SIZE = 80; // 2 lines of 40 characters
+
+    char _ddram[DDRAM_SIZE]; // what is in the controller
+    bool _framing = false; // stays false without frames
+    uint32_t _writes = 0; // commands and data submitted
+    uint8_t _page = 0; // visible page when using hidden DDRAM as back page
+#if MBED_CONF_TEXTDISPLAY_FRAMES
+    char _frame[DDRAM_SIZE]; // screen being composed, page 0 coordinates
+    uint8_t _priority[DDRAM_SIZE] = {0}; // of the changed cells in the frame
+    uint8_t _write_priority = 0;
+#endif
+
+    lcd_font_t _font = FONT_JAPANESE;
+    lcd_char_t _chars = CHAR_5X8;
+    bool _utf8 = false;
+    uint32_t _utf8_code = 0;
+    uint8_t _utf8_pending = 0; // continuation bytes to come
+
+    uint16_t _cgram_code[8] = {0}; // code point of generated glyph, 0 if free
+    uint8_t _cgram_user = 0; // locations filled by create()
+    uint8_t _cgram_next = 0;
+    uint8_t _cgram[64] = {0};
+
+#if MBED_CONF_TEXTDISPLAY_ANIMATIONS
+    struct animation_t {
+        const uint8_t (*frames)[8];
+        uint8_t count;
+        uint8_t frame;
+        int event;
+    };
+
+    animation_t _animations[8] = {};
+#endif
+
+    PlatformMutex _mutex;
+    Kernel::Clock::duration_u32 _idle_timeout{MBED_CONF_TEXTDISPLAY_IDLE_TIMEOUT};
+    Kernel::Clock::time_point _last_activity;
+    int _idle_event = 0;
+    bool _sleeping = false;
+
+    enum recover_stage_t {
+        RECOVER_INIT,
+        RECOVER_CGRAM,
+        RECOVER_DDRAM,
+        RECOVER_DONE
+    };
+
+    bool _initialized = false;
+    bool _offline = false; // bus failed, writes go to shadow only
+    bool _recovering = false;
+    uint32_t _faults = 0;
+    uint8_t _recover_stage = RECOVER_DONE;
+    uint8_t _recover_pos = 0;
+    int _recover_event = 0;
+
+    Kernel::Clock::duration_u32 _scrub_interval{MBED_CONF_TEXTDISPLAY_SCRUB_INTERVAL};
+    uint8_t _scrub_pos = 0; // DDRAM index, CGRAM follows
+    int _scrub_event = 0;
+
+#if MBED_CONF_TEXTDISPLAY_POST
+    char _posted[DDRAM_SIZE]; // by screen position, row * columns + column
+    volatile uint32_t _posted_dirty[(DDRAM_SIZE + 31) / 32] = {0};
+    volatile bool _drain_pending = false;
+    int _drain_event = 0;
+    EventQueue *_post_queue = nullptr; // resolved by init(), shared queue can't be created from interrupt
+#endif
+
+    enum op_type_t {
+        OP_COMMAND,     // instruction with wait or busy flag
+        OP_DATA,        // data with wait or busy flag
+        OP_BITS,        // 4 bits only
+        OP_INSTRUCTION, // slow instruction, wait follows separately
+        OP_READY,       // wait or busy flag
+        OP_WAIT_US,     // short wait, busy loop
+        OP_SLEEP_MS,    // long wait, timed event
+        OP_NOTIFY       // init finished
+    };
+
+    struct op_t {
+        uint8_t type;
+        uint8_t value;
+    };
+
+    EventQueue *_queue = nullptr;
+    bool _ops_running = false;
+    bool _paced = false; // pin changes are buffered by the backend
+#if MBED_CONF_TEXTDISPLAY_OP_QUEUE_SIZE
+    op_t _ops[MBED_CONF_TEXTDISPLAY_OP_QUEUE_SIZE];
+    uint16_t _ops_head = 0;
+    uint16_t _ops_tail = 0;
+    int _ops_event = 0;
+    Kernel::Clock::time_point _ops_resume; // end of the pending sleep
+
+    void runOps();
+    void flushOps();
+#endif
+
+#if MBED_CONF_TEXTDISPLAY_TRACE
+    FileHandle *_trace_file = nullptr;
+    Timer _trace_timer;
+    uint8_t _trace[MBED_CONF_TEXTDISPLAY_TRACE_BUFFER];
+    uint16_t _trace_len = 0;
+
+    void flushTrace();
+#endif
+
+#if MBED_CONF_TEXTDISPLAY_MIRROR
+    enum mirror_record_t { // screen position (row * columns + column) and length start a cell run
+        MIRROR_GLYPH = 0xF0, // | location, 8 bytes follow
+        MIRROR_END   = 0xFF  // end of update
+    };
+
+    FileHandle *_mirror_file = nullptr;
+    Kernel::Clock::duration_u32 _mirror_interval{0};
+    Kernel::Clock::time_point _mirror_last;
+    int _mirror_event = 0;
+    char _mirror[DDRAM_SIZE]; // screen as sent, by screen position
+    uint8_t _mirror_cgram = 0; // locations changed since
+
+    void scheduleMirror();
+    void mirrorStep();
+#endif
+
+    uint32_t _init_faults = 0; // count before init
+    Callback<void(bool)> _init_done;
+
+    // state of the controller as written so far, commands not changing it are skipped
+    static const uint8_t CACHE_UNKNOWN = 0xFF;
+    uint8_t _ac_cache = 0; // address command matching the address counter, 0 if unknown
+    bool _read_valid = false; // data register loaded from the address counter, not holding a written byte
+    uint8_t _control_cache = CACHE_UNKNOWN;
+    uint8_t _entry_cache = CACHE_UNKNOWN;
+
     // Stream implementation functions
     int _putc(int value);
     int _getc();
 
     void pulseEnable();
+    void pinRs(bool state);
+    void pinRw(bool state);
+    void pinEn(bool state);
+    void pinWrite(uint8_t pins);
+    uint8_t pinRead();
     uint8_t getAddress(uint8_t column, uint8_t row);
+    uint8_t pageOffset();
+    bool hasBackPage();
+    void writeLine(uint8_t row, const char *text, uint8_t length);
+#if MBED_CONF_TEXTDISPLAY_FRAMES
+    void flushFrame(uint8_t width, uint8_t offset);
+    uint8_t frameTarget(uint8_t index);
+#endif
+
+    int decode(uint8_t value);
+    uint8_t translate(uint32_t code_point);
+    uint8_t glyphCode(uint32_t code_point);
+    bool glyphShown(uint8_t location);
+    void writeGlyph(uint8_t location, const uint8_t charmap[]);
+#if MBED_CONF_TEXTDISPLAY_ANIMATIONS
+    void animationStep(uint8_t location);
+#endif
+    void idleCheck();
+    bool configure();
+    void clear();
+    void returnHome();
+    void startRecovery();
+    void recoverStep();
+    uint8_t scrubRange(uint8_t from, uint8_t to);
+    void scrubStep();
+#if MBED_CONF_TEXTDISPLAY_POST
+    void drainPosted();
+#endif
+    void setAddress(uint8_t command);
+    void setControl(uint8_t control);
+    void setEntryMode(uint8_t mode);
+    void advanceAddress();
+    void invalidateCache();
+    void submit(uint8_t type, uint8_t value = 0);
+    void runOp(uint8_t type, uint8_t value);
+
+    static uint8_t toIndex(uint8_t address);
+    static uint8_t toAddress(uint8_t index);
 
     virtual uint8_t dataRead() = 0;
     virtual void dataWrite(uint8_t pins) = 0;
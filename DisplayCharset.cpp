@@ -0,0 +1,197 @@
+/*
+MIT License
+Copyright (c) 2021 Pavel Slama
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <string.h>
+#include "DisplayCharset.h"
+#include "DisplayBase.h"
+
+constexpr DisplayCharset::rom_entry_t DisplayCharset::japanese[];
+constexpr DisplayCharset::rom_entry_t DisplayCharset::european_ii[];
+constexpr DisplayCharset::rom_entry_t DisplayCharset::russian[];
+constexpr DisplayCharset::rom_entry_t DisplayCharset::lookalike[];
+constexpr DisplayCharset::glyph_entry_t DisplayCharset::glyphs[];
+
+const uint8_t DisplayCharset::marks[][2] = {
+    {0b00000, 0b00000}, // none
+    {0b00010, 0b00100}, // acute
+    {0b01010, 0b00100}, // caron
+    {0b01110, 0b01010}, // ring
+    {0b01010, 0b00000}, // diaeresis
+    {0b10001, 0b01110}, // breve
+};
+
+const uint8_t DisplayCharset::bases[BASE_COUNT][8] = {
+    {0b00000, 0b00000, 0b01110, 0b00001, 0b01111, 0b10001, 0b01111, 0b00000}, // a
+    {0b00000, 0b00000, 0b01110, 0b10000, 0b10000, 0b10001, 0b01110, 0b00000}, // c
+    {0b00001, 0b00001, 0b01101, 0b10011, 0b10001, 0b10001, 0b01111, 0b00000}, // d
+    {0b00000, 0b00000, 0b01110, 0b10001, 0b11111, 0b10000, 0b01110, 0b00000}, // e
+    {0b00000, 0b00000, 0b01100, 0b00100, 0b00100, 0b00100, 0b01110, 0b00000}, // dotless i
+    {0b00000, 0b00000, 0b10110, 0b11001, 0b10001, 0b10001, 0b10001, 0b00000}, // n
+    {0b00000, 0b00000, 0b01110, 0b10001, 0b10001, 0b10001, 0b01110, 0b00000}, // o
+    {0b00000, 0b00000, 0b10110, 0b11001, 0b10000, 0b10000, 0b10000, 0b00000}, // r
+    {0b00000, 0b00000, 0b01110, 0b10000, 0b01110, 0b00001, 0b11110, 0b00000}, // s
+    {0b01000, 0b01000, 0b11100, 0b01000, 0b01000, 0b01001, 0b00110, 0b00000}, // t
+    {0b00000, 0b00000, 0b10001, 0b10001, 0b10001, 0b10011, 0b01101, 0b00000}, // u
+    {0b00000, 0b00000, 0b10001, 0b10001, 0b01111, 0b00001, 0b01110, 0b00000}, // y
+    {0b00000, 0b00000, 0b11111, 0b00010, 0b00100, 0b01000, 0b11111, 0b00000}, // z
+    {0b01100, 0b10010, 0b10010, 0b10110, 0b10001, 0b10001, 0b10110, 0b10000}, // sharp s
+    {0b01110, 0b10001, 0b10001, 0b11111, 0b10001, 0b10001, 0b10001, 0b00000}, // A
+    {0b01110, 0b10001, 0b10000, 0b10000, 0b10000, 0b10001, 0b01110, 0b00000}, // C
+    {0b11100, 0b10010, 0b10001, 0b10001, 0b10001, 0b10010, 0b11100, 0b00000}, // D
+    {0b11111, 0b10000, 0b10000, 0b11110, 0b10000, 0b10000, 0b11111, 0b00000}, // E
+    {0b01110, 0b00100, 0b00100, 0b00100, 0b00100, 0b00100, 0b01110, 0b00000}, // I
+    {0b10001, 0b10001, 0b11001, 0b10101, 0b10011, 0b10001, 0b10001, 0b00000}, // N
+    {0b01110, 0b10001, 0b10001, 0b10001, 0b10001, 0b10001, 0b01110, 0b00000}, // O
+    {0b11110, 0b10001, 0b10001, 0b11110, 0b10100, 0b10010, 0b10001, 0b00000}, // R
+    {0b01111, 0b10000, 0b10000, 0b01110, 0b00001, 0b00001, 0b11110, 0b00000}, // S
+    {0b11111, 0b00100, 0b00100, 0b00100, 0b00100, 0b00100, 0b00100, 0b00000}, // T
+    {0b10001, 0b10001, 0b10001, 0b10001, 0b10001, 0b10001, 0b01110, 0b00000}, // U
+    {0b10001, 0b10001, 0b01010, 0b00100, 0b00100, 0b00100, 0b00100, 0b00000}, // Y
+    {0b11111, 0b00001, 0b00010, 0b00100, 0b01000, 0b10000, 0b11111, 0b00000}, // Z
+    {0b11111, 0b10000, 0b10000, 0b11110, 0b10001, 0b10001, 0b11110, 0b00000}, // Б
+    {0b11111, 0b10000, 0b10000, 0b10000, 0b10000, 0b10000, 0b10000, 0b00000}, // Г
+    {0b00110, 0b01010, 0b01010, 0b01010, 0b01010, 0b11111, 0b10001, 0b00000}, // Д
+    {0b10101, 0b10101, 0b10101, 0b01110, 0b10101, 0b10101, 0b10101, 0b00000}, // Ж
+    {0b01110, 0b10001, 0b00001, 0b00110, 0b00001, 0b10001, 0b01110, 0b00000}, // З
+    {0b10001, 0b10001, 0b10011, 0b10101, 0b11001, 0b10001, 0b10001, 0b00000}, // И
+    {0b00111, 0b01001, 0b01001, 0b01001, 0b01001, 0b01001, 0b10001, 0b00000}, // Л
+    {0b11111, 0b10001, 0b10001, 0b10001, 0b10001, 0b10001, 0b10001, 0b00000}, // П
+    {0b00100, 0b01110, 0b10101, 0b10101, 0b10101, 0b01110, 0b00100, 0b00000}, // Ф
+    {0b10010, 0b10010, 0b10010, 0b10010, 0b10010, 0b11111, 0b00001, 0b00000}, // Ц
+    {0b10001, 0b10001, 0b10001, 0b01111, 0b00001, 0b00001, 0b00001, 0b00000}, // Ч
+    {0b10101, 0b10101, 0b10101, 0b10101, 0b10101, 0b10101, 0b11111, 0b00000}, // Ш
+    {0b10101, 0b10101, 0b10101, 0b10101, 0b10101, 0b11111, 0b00001, 0b00000}, // Щ
+    {0b11000, 0b01000, 0b01000, 0b01110, 0b01001, 0b01001, 0b01110, 0b00000}, // Ъ
+    {0b10001, 0b10001, 0b10001, 0b11101, 0b10011, 0b10011, 0b11101, 0b00000}, // Ы
+    {0b10000, 0b10000, 0b10000, 0b11110, 0b10001, 0b10001, 0b11110, 0b00000}, // Ь
+    {0b01110, 0b10001, 0b00001, 0b00111, 0b00001, 0b10001, 0b01110, 0b00000}, // Э
+    {0b10010, 0b10101, 0b10101, 0b11101, 0b10101, 0b10101, 0b10010, 0b00000}, // Ю
+    {0b01111, 0b10001, 0b10001, 0b01111, 0b00101, 0b01001, 0b10001, 0b00000}, // Я
+};
+
+template <typename T, unsigned N>
+const T *DisplayCharset::find(const T(&table)[N], uint32_t code_point) {
+    unsigned low = 0;
+    unsigned high = N;
+
+    while (low < high) {
+        unsigned mid = (low + high) / 2;
+
+        if (table[mid].code_point < code_point) {
+            low = mid + 1;
+
+        } else {
+            high = mid;
+        }
+    }
+
+    if (low < N && table[low].code_point == code_point) {
+        return &table[low];
+    }
+
+    return nullptr;
+}
+
+int16_t DisplayCharset::romCode(uint8_t font, uint32_t code_point) {
+    // lookups are binary searches
+    static_assert(isSorted(japanese), "Japanese table must be sorted by code point");
+    static_assert(isSorted(european_ii), "European II table must be sorted by code point");
+    static_assert(isSorted(russian), "Russian table must be sorted by code point");
+    static_assert(isSorted(lookalike), "Look-alike table must be sorted by code point");
+
+    const rom_entry_t *entry = nullptr;
+
+    if (code_point < 0x80) {
+        return code_point;
+    }
+
+    switch (font) {
+        case DisplayBase::FONT_JAPANESE:
+            if (code_point >= 0xFF61 && code_point <= 0xFF9F) { // half-width katakana are in ROM order
+                return 0xA1 + (code_point - 0xFF61);
+            }
+
+            entry = find(japanese, code_point);
+            break;
+
+        case DisplayBase::FONT_EUROPEAN_I:
+            if (code_point >= 0xA1 && code_point <= 0xFF) { // Latin-1 supplement is in ROM order
+                return code_point;
+            }
+
+            break;
+
+        case DisplayBase::FONT_EUROPEAN_II:
+            entry = find(european_ii, code_point);
+            break;
+
+        case DisplayBase::FONT_RUSSIAN:
+            entry = find(russian, code_point);
+            break;
+
+        default:
+            break;
+    }
+
+    if (entry == nullptr && font != DisplayBase::FONT_RUSSIAN) {
+        entry = find(lookalike, code_point);
+    }
+
+    if (entry == nullptr) {
+        return -1;
+    }
+
+    return entry->code;
+}
+
+bool DisplayCharset::glyph(uint32_t code_point, uint8_t charmap[8], char *fallback) {
+    static_assert(isSorted(glyphs), "Glyph table must be sorted by code point");
+
+    const glyph_entry_t *entry = find(glyphs, code_point);
+
+    if (entry == nullptr) {
+        *fallback = '?';
+        return false;
+    }
+
+    const uint8_t *base = bases[entry->base];
+    *fallback = entry->fallback;
+
+    if (entry->mark == MARK_NONE) {
+        memcpy(charmap, base, 8);
+        return true;
+    }
+
+    charmap[0] = marks[entry->mark][0];
+    charmap[1] = marks[entry->mark][1];
+
+    if (entry->base < BASE_A) { // lowercase letters have the top rows free
+        charmap[0] |= base[0];
+        charmap[1] |= base[1];
+        memcpy(&charmap[2], &base[2], 6);
+
+    } else { // drop the 3rd row of uppercase letters to make room for the mark
+        charmap[2] = base[0];
+        charmap[3] = base[1];
+        memcpy(&charmap[4], &base[3], 4);
+    }
+
+    return true;
+}
@@ -0,0 +1,294 @@
+/*
+MIT License
+Copyright (c) 2021 Pavel Slama
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef DISPLAY_CHARSET_H
+#define DISPLAY_CHARSET_H
+
+#include <stdint.h>
+
+class DisplayCharset {
+  public:
+    /**
+     * @brief Find a code point in the character ROM
+     *
+     * @param font Font table of the controller (lcd_font_t)
+     * @param code_point Unicode code point
+     *
+     * @return ROM code, -1 if the ROM doesn't contain it
+     */
+    static int16_t romCode(uint8_t font, uint32_t code_point);
+
+    /**
+     * @brief Render a glyph for a code point missing in the ROM
+     *
+     * @param code_point Unicode code point
+     * @param charmap 8 bytes to be filled with the glyph
+     * @param fallback ASCII replacement if there is no room in CGRAM
+     *
+     * @return true if glyph was rendered, false otherwise
+     */
+    static bool glyph(uint32_t code_point, uint8_t charmap[8], char *fallback);
+
+  private:
+    enum mark_t {
+        MARK_NONE,
+        MARK_ACUTE,
+        MARK_CARON,
+        MARK_RING,
+        MARK_DIAERESIS,
+        MARK_BREVE
+    };
+
+    struct rom_entry_t {
+        uint16_t code_point;
+        uint8_t code;
+    };
+
+    struct glyph_entry_t {
+        uint16_t code_point;
+        uint8_t base;
+        uint8_t mark;
+        char fallback;
+    };
+
+    template <typename T, unsigned N>
+    static constexpr bool isSorted(const T(&table)[N], unsigned i = 1) {
+        return i >= N || (table[i - 1].code_point < table[i].code_point && isSorted(table, i + 1));
+    }
+
+    template <typename T, unsigned N>
+    static const T *find(const T(&table)[N], uint32_t code_point);
+
+    static constexpr rom_entry_t japanese[] = {
+        {0x00A2, 0xEC}, // ¢
+        {0x00A5, 0x5C}, // ¥
+        {0x00B0, 0xDF}, // °
+        {0x00B5, 0xE4}, // µ
+        {0x00B7, 0xA5}, // ·
+        {0x00DF, 0xE2}, // ß
+        {0x00E4, 0xE1}, // ä
+        {0x00F1, 0xEE}, // ñ
+        {0x00F6, 0xEF}, // ö
+        {0x00F7, 0xFD}, // ÷
+        {0x00FC, 0xF5}, // ü
+        {0x03A3, 0xF6}, // Σ
+        {0x03A9, 0xF4}, // Ω
+        {0x03B1, 0xE0}, // α
+        {0x03B2, 0xE2}, // β
+        {0x03B5, 0xE3}, // ε
+        {0x03B8, 0xF2}, // θ
+        {0x03BC, 0xE4}, // μ
+        {0x03C0, 0xF7}, // π
+        {0x03C1, 0xE6}, // ρ
+        {0x2190, 0x7F}, // ←
+        {0x2192, 0x7E}, // →
+        {0x221A, 0xE8}, // √
+        {0x221E, 0xF3}, // ∞
+        {0x2588, 0xFF}, // █
+        {0x3001, 0xA4}, // 、
+        {0x3002, 0xA1}, // 。
+        {0x300C, 0xA2}, // 「
+        {0x300D, 0xA3}, // 」
+        {0x309B, 0xDE}, // ゛
+        {0x309C, 0xDF}, // ゜
+        {0x30A1, 0xA7}, {0x30A2, 0xB1}, {0x30A3, 0xA8}, {0x30A4, 0xB2}, // ァアィイ
+        {0x30A5, 0xA9}, {0x30A6, 0xB3}, {0x30A7, 0xAA}, {0x30A8, 0xB4}, // ゥウェエ
+        {0x30A9, 0xAB}, {0x30AA, 0xB5}, {0x30AB, 0xB6}, {0x30AD, 0xB7}, // ォオカキ
+        {0x30AF, 0xB8}, {0x30B1, 0xB9}, {0x30B3, 0xBA}, {0x30B5, 0xBB}, // クケコサ
+        {0x30B7, 0xBC}, {0x30B9, 0xBD}, {0x30BB, 0xBE}, {0x30BD, 0xBF}, // シスセソ
+        {0x30BF, 0xC0}, {0x30C1, 0xC1}, {0x30C3, 0xAF}, {0x30C4, 0xC2}, // タチッツ
+        {0x30C6, 0xC3}, {0x30C8, 0xC4}, {0x30CA, 0xC5}, {0x30CB, 0xC6}, // テトナニ
+        {0x30CC, 0xC7}, {0x30CD, 0xC8}, {0x30CE, 0xC9}, {0x30CF, 0xCA}, // ヌネノハ
+        {0x30D2, 0xCB}, {0x30D5, 0xCC}, {0x30D8, 0xCD}, {0x30DB, 0xCE}, // ヒフヘホ
+        {0x30DE, 0xCF}, {0x30DF, 0xD0}, {0x30E0, 0xD1}, {0x30E1, 0xD2}, // マミムメ
+        {0x30E2, 0xD3}, {0x30E3, 0xAC}, {0x30E4, 0xD4}, {0x30E5, 0xAD}, // モャヤュ
+        {0x30E6, 0xD5}, {0x30E7, 0xAE}, {0x30E8, 0xD6}, {0x30E9, 0xD7}, // ユョヨラ
+        {0x30EA, 0xD8}, {0x30EB, 0xD9}, {0x30EC, 0xDA}, {0x30ED, 0xDB}, // リルレロ
+        {0x30EF, 0xDC}, {0x30F2, 0xA6}, {0x30F3, 0xDD}, {0x30FB, 0xA5}, // ワヲン・
+        {0x30FC, 0xB0}, // ー
+    };
+
+    // Winstar Western European II layout, upper half of code page 437
+    static constexpr rom_entry_t european_ii[] = {
+        {0x00A1, 0xAD}, // ¡
+        {0x00A2, 0x9B}, // ¢
+        {0x00A3, 0x9C}, // £
+        {0x00A5, 0x9D}, // ¥
+        {0x00AA, 0xA6}, // ª
+        {0x00AB, 0xAE}, // «
+        {0x00B0, 0xF8}, // °
+        {0x00B1, 0xF1}, // ±
+        {0x00B2, 0xFD}, // ²
+        {0x00B5, 0xE6}, // µ
+        {0x00BA, 0xA7}, // º
+        {0x00BB, 0xAF}, // »
+        {0x00BC, 0xAC}, // ¼
+        {0x00BD, 0xAB}, // ½
+        {0x00BF, 0xA8}, // ¿
+        {0x00C4, 0x8E}, {0x00C5, 0x8F}, {0x00C6, 0x92}, {0x00C7, 0x80}, // ÄÅÆÇ
+        {0x00C9, 0x90}, {0x00D1, 0xA5}, {0x00D6, 0x99}, {0x00DC, 0x9A}, // ÉÑÖÜ
+        {0x00DF, 0xE1}, {0x00E0, 0x85}, {0x00E1, 0xA0}, {0x00E2, 0x83}, // ßàáâ
+        {0x00E4, 0x84}, {0x00E5, 0x86}, {0x00E6, 0x91}, {0x00E7, 0x87}, // äåæç
+        {0x00E8, 0x8A}, {0x00E9, 0x82}, {0x00EA, 0x88}, {0x00EB, 0x89}, // èéêë
+        {0x00EC, 0x8D}, {0x00ED, 0xA1}, {0x00EE, 0x8C}, {0x00EF, 0x8B}, // ìíîï
+        {0x00F1, 0xA4}, {0x00F2, 0x95}, {0x00F3, 0xA2}, {0x00F4, 0x93}, // ñòóô
+        {0x00F6, 0x94}, {0x00F7, 0xF6}, {0x00F9, 0x97}, {0x00FA, 0xA3}, // ö÷ùú
+        {0x00FB, 0x96}, {0x00FC, 0x81}, {0x00FF, 0x98}, // ûüÿ
+        {0x03A3, 0xE4}, // Σ
+        {0x03A9, 0xEA}, // Ω
+        {0x03B1, 0xE0}, // α
+        {0x03C0, 0xE3}, // π
+        {0x221A, 0xFB}, // √
+        {0x221E, 0xEC}, // ∞
+        {0x2588, 0xDB}, // █
+    };
+
+    // Winstar cyrillic layout
+    static constexpr rom_entry_t russian[] = {
+        {0x0401, 0xA2}, // Ё
+        {0x0410, 0x41}, {0x0411, 0xA0}, {0x0412, 0x42}, {0x0413, 0xA1}, // АБВГ
+        {0x0414, 0xE0}, {0x0415, 0x45}, {0x0416, 0xA3}, {0x0417, 0xA4}, // ДЕЖЗ
+        {0x0418, 0xA5}, {0x0419, 0xA6}, {0x041A, 0x4B}, {0x041B, 0xA7}, // ИЙКЛ
+        {0x041C, 0x4D}, {0x041D, 0x48}, {0x041E, 0x4F}, {0x041F, 0xA8}, // МНОП
+        {0x0420, 0x50}, {0x0421, 0x43}, {0x0422, 0x54}, {0x0423, 0xA9}, // РСТУ
+        {0x0424, 0xAA}, {0x0425, 0x58}, {0x0426, 0xE1}, {0x0427, 0xAB}, // ФХЦЧ
+        {0x0428, 0xAC}, {0x0429, 0xE2}, {0x042A, 0xAD}, {0x042B, 0xAE}, // ШЩЪЫ
+        {0x042C, 0x62}, {0x042D, 0xAF}, {0x042E, 0xB0}, {0x042F, 0xB1}, // ЬЭЮЯ
+        {0x0430, 0x61}, {0x0431, 0xB2}, {0x0432, 0xB3}, {0x0433, 0xB4}, // абвг
+        {0x0434, 0xE3}, {0x0435, 0x65}, {0x0436, 0xB6}, {0x0437, 0xB7}, // дежз
+        {0x0438, 0xB8}, {0x0439, 0xB9}, {0x043A, 0xBA}, {0x043B, 0xBB}, // ийкл
+        {0x043C, 0xBC}, {0x043D, 0xBD}, {0x043E, 0x6F}, {0x043F, 0xBE}, // мноп
+        {0x0440, 0x70}, {0x0441, 0x63}, {0x0442, 0xBF}, {0x0443, 0x79}, // рсту
+        {0x0444, 0xE4}, {0x0445, 0x78}, {0x0446, 0xE5}, {0x0447, 0xC0}, // фхцч
+        {0x0448, 0xC1}, {0x0449, 0xE6}, {0x044A, 0xC2}, {0x044B, 0xC3}, // шщъы
+        {0x044C, 0xC4}, {0x044D, 0xC5}, {0x044E, 0xC6}, {0x044F, 0xC7}, // ьэюя
+        {0x0451, 0xB5}, // ё
+    };
+
+    // cyrillic letters that look like latin ones, used with non-cyrillic ROMs
+    static constexpr rom_entry_t lookalike[] = {
+        {0x0410, 'A'}, {0x0412, 'B'}, {0x0415, 'E'}, {0x041A, 'K'},
+        {0x041C, 'M'}, {0x041D, 'H'}, {0x041E, 'O'}, {0x0420, 'P'},
+        {0x0421, 'C'}, {0x0422, 'T'}, {0x0423, 'Y'}, {0x0425, 'X'},
+        {0x0430, 'a'}, {0x0432, 'B'}, {0x0435, 'e'}, {0x043A, 'k'},
+        {0x043C, 'M'}, {0x043D, 'H'}, {0x043E, 'o'}, {0x0440, 'p'},
+        {0x0441, 'c'}, {0x0442, 'T'}, {0x0443, 'y'}, {0x0445, 'x'},
+    };
+
+    enum base_t {
+        // lowercase, 8 rows
+        BASE_a, BASE_c, BASE_d, BASE_e, BASE_dotless_i, BASE_n, BASE_o,
+        BASE_r, BASE_s, BASE_t, BASE_u, BASE_y, BASE_z, BASE_sharp_s,
+        // uppercase, 7 rows, squeezed under the mark
+        BASE_A, BASE_C, BASE_D, BASE_E, BASE_I, BASE_N, BASE_O,
+        BASE_R, BASE_S, BASE_T, BASE_U, BASE_Y, BASE_Z,
+        BASE_BE, BASE_GHE, BASE_DE, BASE_ZHE, BASE_ZE, BASE_I_CYR, BASE_EL,
+        BASE_PE, BASE_EF, BASE_TSE, BASE_CHE, BASE_SHA, BASE_SHCHA, BASE_HARD,
+        BASE_YERU, BASE_SOFT, BASE_E_CYR, BASE_YU, BASE_YA,
+        BASE_COUNT
+    };
+
+    static const uint8_t bases[BASE_COUNT][8];
+    static const uint8_t marks[][2];
+
+    static constexpr glyph_entry_t glyphs[] = {
+        {0x00C1, BASE_A, MARK_ACUTE, 'A'},          // Á
+        {0x00C4, BASE_A, MARK_DIAERESIS, 'A'},      // Ä
+        {0x00C9, BASE_E, MARK_ACUTE, 'E'},          // É
+        {0x00CD, BASE_I, MARK_ACUTE, 'I'},          // Í
+        {0x00D3, BASE_O, MARK_ACUTE, 'O'},          // Ó
+        {0x00D6, BASE_O, MARK_DIAERESIS, 'O'},      // Ö
+        {0x00DA, BASE_U, MARK_ACUTE, 'U'},          // Ú
+        {0x00DC, BASE_U, MARK_DIAERESIS, 'U'},      // Ü
+        {0x00DD, BASE_Y, MARK_ACUTE, 'Y'},          // Ý
+        {0x00DF, BASE_sharp_s, MARK_NONE, 's'},     // ß
+        {0x00E1, BASE_a, MARK_ACUTE, 'a'},          // á
+        {0x00E4, BASE_a, MARK_DIAERESIS, 'a'},      // ä
+        {0x00E9, BASE_e, MARK_ACUTE, 'e'},          // é
+        {0x00ED, BASE_dotless_i, MARK_ACUTE, 'i'},  // í
+        {0x00F3, BASE_o, MARK_ACUTE, 'o'},          // ó
+        {0x00F6, BASE_o, MARK_DIAERESIS, 'o'},      // ö
+        {0x00FA, BASE_u, MARK_ACUTE, 'u'},          // ú
+        {0x00FC, BASE_u, MARK_DIAERESIS, 'u'},      // ü
+        {0x00FD, BASE_y, MARK_ACUTE, 'y'},          // ý
+        {0x010C, BASE_C, MARK_CARON, 'C'},          // Č
+        {0x010D, BASE_c, MARK_CARON, 'c'},          // č
+        {0x010E, BASE_D, MARK_CARON, 'D'},          // Ď
+        {0x010F, BASE_d, MARK_CARON, 'd'},          // ď
+        {0x011A, BASE_E, MARK_CARON, 'E'},          // Ě
+        {0x011B, BASE_e, MARK_CARON, 'e'},          // ě
+        {0x0147, BASE_N, MARK_CARON, 'N'},          // Ň
+        {0x0148, BASE_n, MARK_CARON, 'n'},          // ň
+        {0x0158, BASE_R, MARK_CARON, 'R'},          // Ř
+        {0x0159, BASE_r, MARK_CARON, 'r'},          // ř
+        {0x0160, BASE_S, MARK_CARON, 'S'},          // Š
+        {0x0161, BASE_s, MARK_CARON, 's'},          // š
+        {0x0164, BASE_T, MARK_CARON, 'T'},          // Ť
+        {0x0165, BASE_t, MARK_CARON, 't'},          // ť
+        {0x016E, BASE_U, MARK_RING, 'U'},           // Ů
+        {0x016F, BASE_u, MARK_RING, 'u'},           // ů
+        {0x017D, BASE_Z, MARK_CARON, 'Z'},          // Ž
+        {0x017E, BASE_z, MARK_CARON, 'z'},          // ž
+        {0x0401, BASE_E, MARK_DIAERESIS, 'E'},      // Ё
+        {0x0411, BASE_BE, MARK_NONE, 'B'},          // Б
+        {0x0413, BASE_GHE, MARK_NONE, 'G'},         // Г
+        {0x0414, BASE_DE, MARK_NONE, 'D'},          // Д
+        {0x0416, BASE_ZHE, MARK_NONE, 'Z'},         // Ж
+        {0x0417, BASE_ZE, MARK_NONE, 'Z'},          // З
+        {0x0418, BASE_I_CYR, MARK_NONE, 'I'},       // И
+        {0x0419, BASE_I_CYR, MARK_BREVE, 'J'},      // Й
+        {0x041B, BASE_EL, MARK_NONE, 'L'},          // Л
+        {0x041F, BASE_PE, MARK_NONE, 'P'},          // П
+        {0x0424, BASE_EF, MARK_NONE, 'F'},          // Ф
+        {0x0426, BASE_TSE, MARK_NONE, 'C'},         // Ц
+        {0x0427, BASE_CHE, MARK_NONE, 'C'},         // Ч
+        {0x0428, BASE_SHA, MARK_NONE, 'S'},         // Ш
+        {0x0429, BASE_SHCHA, MARK_NONE, 'S'},       // Щ
+        {0x042A, BASE_HARD, MARK_NONE, '\''},       // Ъ
+        {0x042B, BASE_YERU, MARK_NONE, 'Y'},        // Ы
+        {0x042C, BASE_SOFT, MARK_NONE, '\''},       // Ь
+        {0x042D, BASE_E_CYR, MARK_NONE, 'E'},       // Э
+        {0x042E, BASE_YU, MARK_NONE, 'U'},          // Ю
+        {0x042F, BASE_YA, MARK_NONE, 'A'},          // Я
+        {0x0431, BASE_BE, MARK_NONE, 'b'},          // б
+        {0x0433, BASE_GHE, MARK_NONE, 'g'},         // г
+        {0x0434, BASE_DE, MARK_NONE, 'd'},          // д
+        {0x0436, BASE_ZHE, MARK_NONE, 'z'},         // ж
+        {0x0437, BASE_ZE, MARK_NONE, 'z'},          // з
+        {0x0438, BASE_I_CYR, MARK_NONE, 'i'},       // и
+        {0x0439, BASE_I_CYR, MARK_BREVE, 'j'},      // й
+        {0x043B, BASE_EL, MARK_NONE, 'l'},          // л
+        {0x043F, BASE_PE, MARK_NONE, 'p'},          // п
+        {0x0444, BASE_EF, MARK_NONE, 'f'},          // ф
+        {0x0446, BASE_TSE, MARK_NONE, 'c'},         // ц
+        {0x0447, BASE_CHE, MARK_NONE, 'c'},         // ч
+        {0x0448, BASE_SHA, MARK_NONE, 's'},         // ш
+        {0x0449, BASE_SHCHA, MARK_NONE, 's'},       // щ
+        {0x044A, BASE_HARD, MARK_NONE, '\''},       // ъ
+        {0x044B, BASE_YERU, MARK_NONE, 'y'},        // ы
+        {0x044C, BASE_SOFT, MARK_NONE, '\''},       // ь
+        {0x044D, BASE_E_CYR, MARK_NONE, 'e'},       // э
+        {0x044E, BASE_YU, MARK_NONE, 'u'},          // ю
+        {0x044F, BASE_YA, MARK_NONE, 'a'},          // я
+        {0x0451, BASE_e, MARK_DIAERESIS, 'e'},      // ё
+    };
+};
+
+#endif
@@ -0,0 +1,137 @@
+/*
+MIT License
+Copyright (c) 2021 Pavel Slama
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "DisplayI2C.h"
+
+DisplayI2C::DisplayI2C(lcd_size_t size, int8_t address, uint32_t frequency):
+    DisplayBase{size, false},
+    _i2c_addr(address) {
+    setPad(frequency);
+}
+
+DisplayI2C::DisplayI2C(PinName sda, PinName scl, lcd_size_t size, int8_t address, uint32_t frequency):
+    DisplayBase{size, false},
+    _i2c_addr(address) {
+    _i2c = new (_i2c_obj) I2C(sda, scl);
+    _i2c->frequency(frequency);
+    setPad(frequency);
+}
+
+DisplayI2C::~DisplayI2C() {
+    if (_i2c == reinterpret_cast<I2C *>(_i2c_obj)) {
+        _i2c->~I2C();
+    }
+}
+
+void DisplayI2C::setPad(uint32_t frequency) {
+    // one byte takes 9 clocks, execution time is 37us
+    _pad = (40 * (frequency / 1000) + 8999) / 9000;
+
+    if (_pad == 0) {
+        _pad = 1;
+    }
+}
+
+void DisplayI2C::initI2C(I2C *i2c_obj) {
+    if (i2c_obj != nullptr) {
+        _i2c = i2c_obj;
+    }
+
+    MBED_ASSERT(_i2c);
+}
+
+void DisplayI2C::writeByte(uint8_t value) {
+    record(TRACE_BYTE, value);
+
+    if (_items_len == sizeof(_items)) {
+        flushStream();
+    }
+
+    _items_rs &= ~(1UL << _items_len);
+    _items_rs |= (uint32_t)_rs << _items_len;
+    _items[_items_len++] = value;
+
+    if (_batch_depth == 0) {
+        flushStream();
+    }
+}
+
+bool DisplayI2C::beginBatch() {
+    _batch_depth++;
+
+    return true;
+}
+
+bool DisplayI2C::endBatch() {
+    _batch_depth--;
+
+    // control and value byte of the next operation have to cover the execution time
+    if (_batch_depth == 0 || _pad > 2) {
+        flushStream();
+        return false;
+    }
+
+    return true;
+}
+
+void DisplayI2C::flushBatch() {
+    flushStream();
+}
+
+bool DisplayI2C::flushStream() {
+    int32_t ack;
+    uint8_t len = 0;
+    uint8_t last = _items_len;
+
+    if (_items_len == 0) {
+        return true;
+    }
+
+    // bytes after the last control byte go without prefix, if the bus is slow enough
+    if (_pad == 1) {
+        bool data = _items_rs & (1UL << (_items_len - 1));
+
+        while (last > 1 && (bool)(_items_rs & (1UL << (last - 2))) == data) {
+            last--;
+        }
+    }
+
+    for (auto i = 0; i < _items_len; i++) {
+        if (i < last) {
+            bool data = _items_rs & (1UL << i);
+            _stream[len++] = (i < last - 1 ? CONTROL_CO : 0) | (data ? CONTROL_DC : 0);
+        }
+
+        _stream[len++] = _items[i];
+    }
+
+    _i2c->lock();
+    ack = _i2c->write(_i2c_addr, _stream, len);
+    _i2c->unlock();
+
+    _items_len = 0;
+
+    if (ack != 0) {
+        reportFault();
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,98 @@
+/*
+MIT License
+Copyright (c) 2021 Pavel Slama
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef DISPLAY_I2C_H
+#define DISPLAY_I2C_H
+
+#include "DisplayBase.h"
+
+/**
+ * Base for controllers with native I2C interface (ST7032i, SSD1311/US2066)
+ * Every byte is preceded by a control byte (Co, D/C), display can't be read
+ */
+class DisplayI2C: public DisplayBase {
+  public:
+    /**
+     * @brief Destructor
+     *
+     */
+    ~DisplayI2C();
+
+  protected:
+    /**
+     * @brief Create a native I2C display interface
+     *
+     * @param size Panel size
+     * @param address 7-bit I2C address of the controller
+     * @param frequency I2C bus speed, used for spacing of the streamed writes
+     */
+    DisplayI2C(lcd_size_t size, int8_t address, uint32_t frequency);
+
+    /**
+     * @brief Create a native I2C display interface
+     *
+     * @param sda SDA pin
+     * @param scl SCL pin
+     * @param size Panel size
+     * @param address 7-bit I2C address of the controller
+     * @param frequency I2C bus speed
+     */
+    DisplayI2C(PinName sda, PinName scl, lcd_size_t size, int8_t address, uint32_t frequency);
+
+    void initI2C(I2C *i2c_obj = nullptr);
+    void writeByte(uint8_t value) override;
+    void reset() override {};
+    bool beginBatch() override;
+    bool endBatch() override;
+    void flushBatch() override;
+    void rs(bool state) override {
+        _rs = state;
+    };
+
+  private:
+    static const uint8_t CONTROL_CO = 0b10000000; // another control byte follows
+    static const uint8_t CONTROL_DC = 0b1000000; // data, instruction otherwise
+
+    I2C *_i2c = nullptr;
+    const int8_t _i2c_addr;
+    uint8_t _pad = 1; // bytes taking execution time of the display
+    bool _rs = false;
+
+    uint8_t _batch_depth = 0;
+    uint8_t _items[24]; // bytes of one transfer
+    uint32_t _items_rs = 0; // bit per item, set for data
+    uint8_t _items_len = 0;
+    char _stream[sizeof(_items) * 2];
+    uint32_t _i2c_obj[sizeof(I2C) / sizeof(uint32_t)] = {0};
+
+    bool flushStream();
+    void setPad(uint32_t frequency);
+
+    uint8_t dataRead() override {
+        return 0;
+    };
+    void dataWrite(uint8_t pins) override {};
+    void dataInput() override {};
+    void dataOutput() override {};
+    void en(bool state) override {};
+    void rw(bool state) override {};
+};
+
+#endif
@@ -0,0 +1,174 @@
+/*
+MIT License
+Copyright (c) 2021 Pavel Slama
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "DisplayList.h"
+
+DisplayList::DisplayList(DisplayBase &display, Callback<void(uint16_t, char *, uint8_t)> item, uint16_t count,
+                         uint8_t first_row, uint8_t rows):
+    _display(display),
+    _item(item),
+    _count(count),
+    _first_row(first_row),
+    _rows(rows) {
+    MBED_ASSERT(first_row < display.rows());
+
+    if (_rows == 0 || _first_row + _rows > _display.rows()) {
+        _rows = _display.rows() - _first_row;
+    }
+
+    if (_rows > MAX_ROWS) {
+        _rows = MAX_ROWS;
+    }
+}
+
+void DisplayList::setCount(uint16_t count) {
+    _count = count;
+    _cached = false;
+
+    if (_selected >= _count) {
+        _selected = _count ? _count - 1 : 0;
+    }
+
+    select(_selected);
+}
+
+void DisplayList::setMarker(char marker) {
+    _marker = marker;
+    _cached = false;
+    draw();
+}
+
+void DisplayList::select(uint16_t index) {
+    if (_count && index >= _count) {
+        index = _count - 1;
+    }
+
+    _selected = index;
+
+    if (_selected < _top) {
+        _top = _selected;
+
+    } else if (_selected >= _top + _rows) {
+        _top = _selected - _rows + 1;
+    }
+
+    draw();
+}
+
+void DisplayList::up() {
+    if (_selected > 0) {
+        select(_selected - 1);
+    }
+}
+
+void DisplayList::down() {
+    if (_selected + 1 < _count) {
+        select(_selected + 1);
+    }
+}
+
+uint16_t DisplayList::selected() {
+    return _selected;
+}
+
+void DisplayList::refresh() {
+    _cached = false;
+    draw();
+}
+
+void DisplayList::invalidate() {
+    _shown_valid = false;
+}
+
+void DisplayList::pull(uint8_t row) {
+    char *text = _items[row];
+    uint16_t index = _top + row;
+
+    memset(text, 0, MAX_COLUMNS + 1);
+
+    if (index < _count) {
+        _item(index, text, MAX_COLUMNS + 1);
+        text[MAX_COLUMNS] = '\0';
+    }
+}
+
+void DisplayList::draw() {
+    uint8_t columns = _display.columns();
+    uint8_t offset = _marker ? 1 : 0;
+
+    // items already rendered only move, the ones scrolled in are pulled
+    if (_cached && _top != _cached_top && (_top > _cached_top ? _top - _cached_top : _cached_top - _top) < _rows) {
+        uint8_t moved = _top > _cached_top ? _top - _cached_top : _cached_top - _top;
+
+        if (_top > _cached_top) {
+            memmove(_items[0], _items[moved], (_rows - moved) * sizeof(_items[0]));
+
+            for (auto row = _rows - moved; row < _rows; row++) {
+                pull(row);
+            }
+
+        } else {
+            memmove(_items[moved], _items[0], (_rows - moved) * sizeof(_items[0]));
+
+            for (auto row = 0; row < moved; row++) {
+                pull(row);
+            }
+        }
+
+    } else if (!_cached || _top != _cached_top) {
+        for (auto row = 0; row < _rows; row++) {
+            pull(row);
+        }
+    }
+
+    _cached = true;
+    _cached_top = _top;
+
+    _display.lock();
+
+    // the controller can't move rows, compare each cell with what is there
+    for (auto row = 0; row < _rows; row++) {
+        const char *text = _items[row];
+        bool end = false;
+
+        for (auto column = 0; column < columns; column++) {
+            char c;
+
+            if (column < offset) {
+                c = (_top + row == _selected) ? _marker : ' ';
+
+            } else {
+                end = end || text[column - offset] == '\0';
+                c = end ? ' ' : text[column - offset];
+            }
+
+            if (_shown_valid && _shown[row][column] == c) {
+                continue;
+            }
+
+            _display.character(column, _first_row + row, c);
+            _shown[row][column] = c;
+        }
+    }
+
+    _shown_valid = true;
+
+    _display.unlock();
+}
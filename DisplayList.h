@@ -0,0 +1,120 @@
+/*
+MIT License
+Copyright (c) 2021 Pavel Slama
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef DISPLAY_LIST_H
+#define DISPLAY_LIST_H
+
+#include "DisplayBase.h"
+
+/**
+ * Scrolling list of items rendered on demand, ie. a menu larger than the panel
+ * Only the cells that changed are written on scroll
+ */
+class DisplayList {
+  public:
+    /**
+     * @brief Create a list viewport, nothing is drawn until refresh() or select()
+     *
+     * @param display where to draw
+     * @param item fills text of the item (index, text, size), display codes, no UTF-8
+     * @param count number of items
+     * @param first_row first row of the viewport
+     * @param rows rows of the viewport, 0 to the bottom of the panel
+     */
+    DisplayList(DisplayBase &display, Callback<void(uint16_t, char *, uint8_t)> item, uint16_t count,
+                uint8_t first_row = 0, uint8_t rows = 0);
+
+    /**
+     * @brief Set the number of items, the visible ones are pulled again
+     *
+     * @param count
+     */
+    void setCount(uint16_t count);
+
+    /**
+     * @brief Set the selection marker, shown in the first column
+     *
+     * @param marker 0 to disable the column
+     */
+    void setMarker(char marker);
+
+    /**
+     * @brief Select an item and scroll to show it
+     *
+     * @param index
+     */
+    void select(uint16_t index);
+
+    /**
+     * @brief Select the previous item
+     *
+     */
+    void up();
+
+    /**
+     * @brief Select the next item
+     *
+     */
+    void down();
+
+    /**
+     * @brief Get selected item
+     *
+     * @return index
+     */
+    uint16_t selected();
+
+    /**
+     * @brief Pull the visible items again and draw the changes
+     *
+     */
+    void refresh();
+
+    /**
+     * @brief Forget what is on the screen, next draw writes every cell (ie. after cls())
+     *
+     */
+    void invalidate();
+
+  private:
+    static const uint8_t MAX_ROWS = 4;
+    static const uint8_t MAX_COLUMNS = 40;
+
+    DisplayBase &_display;
+    Callback<void(uint16_t, char *, uint8_t)> _item;
+    uint16_t _count;
+    const uint8_t _first_row;
+    uint8_t _rows;
+    char _marker = '>';
+
+    uint16_t _top = 0; // item in the first row
+    uint16_t _selected = 0;
+    uint16_t _cached_top = 0;
+    bool _cached = false; // _items hold texts from _cached_top
+    bool _shown_valid = false;
+
+    char _items[MAX_ROWS][MAX_COLUMNS + 1]; // item texts by row
+    char _shown[MAX_ROWS][MAX_COLUMNS]; // what is on the screen
+
+    void pull(uint8_t row);
+    void draw();
+};
+
+#endif
@@ -30,29 +30,42 @@ TextLCD::TextLCD(PinName rs, PinName en, PinName d4, PinName d5, PinName d6, Pin
     TextLCD::en(0);
 
     if (rw != NC) {
-        _rw = new DigitalOut(rw);
+        _rw = new (_rw_obj) DigitalOut(rw);
         TextLCD::rw(1);
     }
 }
 
 TextLCD::~TextLCD() {
     if (_rw) {
-        delete _rw;
+        _rw->~DigitalOut();
     }
 }
 
 bool TextLCD::init(lcd_char_t chars) {
+    reset();
+
+    return DisplayBase::init(FONT_JAPANESE, chars);
+}
+
+void TextLCD::initAsync(Callback<void(bool)> done, lcd_char_t chars) {
+    lock();
+
+    beginInit(done);
+    init(chars);
+
+    unlock();
+}
+
+void TextLCD::reset() {
     // Function Set
     writeBits(0b11); // 8-bit mode
-    ThisThread::sleep_for(5ms); // minimum 4.1ms
+    delay(5ms); // minimum 4.1ms
 
     writeBits(0b0011); // 8-bit mode
-    wait_us(120); // minimum 100us
+    delay(120us); // minimum 100us
 
     // Function Set
     writeBits(0b0011); // 8-bit mode
-
-    return DisplayBase::init(FONT_JAPANESE, chars);
 }
 
 uint8_t TextLCD::dataRead() {
@@ -54,7 +54,19 @@ class TextLCD: public DisplayBase {
      */
     bool init(lcd_char_t chars = CHAR_5X8);
 
+    /**
+     * @brief Initialize display in the background
+     * Waits for the controller to power up, see power-on-delay in mbed_lib.json.
+     * Display stays bound to the event queue, see bind()
+     *
+     * @param done called from the event queue with true if success, false otherwise
+     * @param chars Size of 1 character, can be 5x8 or 5x10 on some displays
+     */
+    void initAsync(Callback<void(bool)> done, lcd_char_t chars = CHAR_5X8);
+
   protected:
+    void reset() override;
+
     uint8_t dataRead() override;
     void dataWrite(uint8_t pins) override;
     void dataInput() override;
@@ -66,8 +78,9 @@ class TextLCD: public DisplayBase {
   private:
     DigitalOut _rs;
     DigitalOut _en;
-    DigitalOut *_rw;
+    DigitalOut *_rw = nullptr;
     BusInOut _data;
+    uint32_t _rw_obj[sizeof(DigitalOut) / sizeof(uint32_t)] = {0};
 };
 
 #endif
@@ -20,15 +20,21 @@ SOFTWARE.
 
 #include "TextLCD_I2C.h"
 
+#define BACKLIGHT_FADE_STEP 20ms
+#define BACKLIGHT_LEVELS 8 // software PWM period is at most this many writes
+
+// speeds tried by tuneFrequency(), PCF8574 is specified for 100kHz but most backpacks handle more
+const uint32_t TextLCD_I2C::frequencies[5] = {100000, 200000, 400000, 700000, 1000000};
+
 TextLCD_I2C::TextLCD_I2C(bool alt_pinmap, lcd_size_t size, int8_t address):
-    DisplayBase{size, false},
+    DisplayBase{size, false, true},
     _i2c_addr(address),
     _alt_pinmap(alt_pinmap) {
 }
 
 TextLCD_I2C::TextLCD_I2C(PinName sda, PinName scl, bool alt_pinmap, lcd_size_t size,
                          int8_t address, uint32_t frequency):
-    DisplayBase{size, false},
+    DisplayBase{size, false, true},
     _i2c_addr(address),
     _alt_pinmap(alt_pinmap) {
     _i2c = new (_i2c_obj) I2C(sda, scl);
@@ -36,6 +42,14 @@ TextLCD_I2C::TextLCD_I2C(PinName sda, PinName scl, bool alt_pinmap, lcd_size_t s
 }
 
 TextLCD_I2C::~TextLCD_I2C() {
+    if (_refresh_event) {
+        queue()->cancel(_refresh_event);
+    }
+
+    if (_fade_event) {
+        queue()->cancel(_fade_event);
+    }
+
     if (_i2c == reinterpret_cast<I2C *>(_i2c_obj)) {
         _i2c->~I2C();
     }
@@ -56,35 +70,64 @@ void TextLCD_I2C::initI2C(I2C *i2c_obj) {
 
 bool TextLCD_I2C::init(I2C *i2c_obj, lcd_char_t chars) {
     initI2C(i2c_obj);
+    reset();
+
+    return DisplayBase::init(FONT_JAPANESE, chars);
+}
 
+void TextLCD_I2C::initAsync(Callback<void(bool)> done, I2C *i2c_obj, lcd_char_t chars) {
+    lock();
+
+    beginInit(done);
+    init(i2c_obj, chars);
+
+    unlock();
+}
+
+void TextLCD_I2C::reset() {
     // Function Set
     writeBits(0b11); // 8-bit mode
-    ThisThread::sleep_for(5ms); // minimum 4.1ms
+    delay(5ms); // minimum 4.1ms
 
     writeBits(0b0011); // 8-bit mode
-    wait_us(120); // minimum 100us
+    delay(120us); // minimum 100us
 
     // Function Set
     writeBits(0b0011); // 8-bit mode
-
-    return DisplayBase::init(FONT_JAPANESE, chars);
 }
 
 uint8_t TextLCD_I2C::dataRead() {
     int32_t ack;
     char buf[1];
 
+    flushBurst(); // enable has to be up before reading
+
     _i2c->lock();
     ack = _i2c->read(_i2c_addr, buf, 1);
     _i2c->unlock();
 
     if (ack != 0) {
+        busError();
         return 0;
     }
 
+    if (_alt_pinmap) {
+        return buf[0] & 0b1111;
+    }
+
     return buf[0] >> 4;
 }
 
+void TextLCD_I2C::dataInput() {
+    // quasi-bidirectional pins, high level is weak and can be pulled down by the display
+    if (_alt_pinmap) {
+        _pins |= 0b00001111;
+
+    } else {
+        _pins |= 0b11110000;
+    }
+}
+
 void TextLCD_I2C::dataWrite(uint8_t pins) {
     if (_alt_pinmap) {
         _pins &= ~0b00001111;
@@ -138,6 +181,204 @@ void TextLCD_I2C::rs(bool state) {
 }
 
 void TextLCD_I2C::setBacklight(bool on) {
+    lock();
+    activity();
+
+    _backlight = on;
+    applyBrightness();
+
+    unlock();
+}
+
+void TextLCD_I2C::attachBacklight(PwmOut *pwm) {
+    lock();
+
+    _pwm = pwm;
+    applyBrightness();
+
+    unlock();
+}
+
+void TextLCD_I2C::setBrightness(float level) {
+    lock();
+
+    if (_fade_event) {
+        queue()->cancel(_fade_event);
+        _fade_event = 0;
+    }
+
+    _level = (level <= 0.0f ? 0.0f : level >= 1.0f ? 1.0f : level) * 255;
+    applyBrightness();
+
+    unlock();
+}
+
+void TextLCD_I2C::fadeBacklight(float level, Kernel::Clock::duration_u32 duration) {
+    lock();
+
+    _fade_from = _level;
+    _fade_to = (level <= 0.0f ? 0.0f : level >= 1.0f ? 1.0f : level) * 255;
+    _fade_steps = duration / BACKLIGHT_FADE_STEP;
+    _fade_step = 0;
+
+    if (_fade_steps == 0) {
+        _fade_steps = 1;
+    }
+
+    if (!_fade_event) {
+        _fade_event = queue()->call_every(BACKLIGHT_FADE_STEP, callback(this, &TextLCD_I2C::fadeStep));
+    }
+
+    unlock();
+}
+
+void TextLCD_I2C::fadeStep() {
+    lock();
+
+    _fade_step++;
+    _level = _fade_from + ((int32_t)_fade_to - _fade_from) * _fade_step / _fade_steps;
+
+    if (_fade_step >= _fade_steps) {
+        queue()->cancel(_fade_event);
+        _fade_event = 0;
+    }
+
+    applyBrightness();
+
+    unlock();
+}
+
+void TextLCD_I2C::applyBrightness() {
+    uint8_t level = (_backlight && !_asleep) ? _level : 0;
+
+    if (_pwm) {
+        float duty = level / 255.0f;
+        _pwm->write(duty * duty); // brightness is perceived roughly as a square root of the duty
+
+        _duty = level ? BACKLIGHT_LEVELS : 0; // keep the backpack bit in line
+        _dither = 0;
+
+    } else if (MBED_CONF_TEXTDISPLAY_BACKLIGHT_PWM_INTERVAL > 0) {
+        _duty = (level * level * BACKLIGHT_LEVELS + 65025 / 2) / 65025;
+
+    } else { // software PWM disabled, it keeps the bus busy
+        _duty = level ? BACKLIGHT_LEVELS : 0;
+    }
+
+    // software PWM needs a write even if the display is idle
+    if (_duty > 0 && _duty < BACKLIGHT_LEVELS) {
+        if (!_refresh_event) {
+            _refresh_event = queue()->call_every(
+                                 std::chrono::milliseconds(MBED_CONF_TEXTDISPLAY_BACKLIGHT_PWM_INTERVAL),
+                                 callback(this, &TextLCD_I2C::backlightRefresh));
+        }
+
+    } else if (_refresh_event) {
+        queue()->cancel(_refresh_event);
+        _refresh_event = 0;
+    }
+
+    if (_i2c && !offline()) {
+        i2cWrite();
+    }
+}
+
+void TextLCD_I2C::backlightRefresh() {
+    lock();
+
+    if (!_traffic && _i2c && !offline()) {
+        i2cWrite();
+    }
+
+    _traffic = false;
+
+    unlock();
+}
+
+void TextLCD_I2C::powerSave(bool enable) {
+    DisplayBase::powerSave(enable);
+
+    _asleep = enable;
+    applyBrightness();
+}
+
+uint32_t TextLCD_I2C::tuneFrequency(uint32_t max_frequency) {
+    uint8_t speed = 0;
+    bool garbled = false;
+
+    MBED_ASSERT(_i2c); // call after init()
+
+    lock();
+    _speed = 0; // failed steps don't count as errors
+
+    for (uint8_t i = 0; i < sizeof(frequencies) / sizeof(frequencies[0]) && frequencies[i] <= max_frequency; i++) {
+        uint32_t count = faults();
+        _i2c->frequency(frequencies[i]);
+
+        if (!verifyBus()) {
+            // NAK starts the recovery itself, a mismatch may have left garbage in the display
+            garbled = i > 0 && faults() == count;
+            break;
+        }
+
+        speed = i;
+    }
+
+    _i2c->frequency(frequencies[speed]);
+    _speed = speed;
+    _bus_errors = 0;
+
+    if (garbled) { // initialize and redraw at the selected speed
+        reportFault();
+    }
+
+    unlock();
+
+    return frequencies[speed];
+}
+
+void TextLCD_I2C::busError() {
+    // errors of an absent display being re-initialized don't say anything about the speed
+    if (offline() || _speed == 0) {
+        reportFault();
+        return;
+    }
+
+    auto now = Kernel::Clock::now();
+
+    // sporadic errors over a long uptime don't count, only the ones close together
+    if (now - _errors_since > std::chrono::milliseconds(MBED_CONF_TEXTDISPLAY_I2C_FALLBACK_WINDOW)) {
+        _errors_since = now;
+        _bus_errors = 0;
+    }
+
+    if (++_bus_errors >= MBED_CONF_TEXTDISPLAY_I2C_FALLBACK_ERRORS) {
+        _speed--;
+        _bus_errors = 0;
+        _i2c->frequency(frequencies[_speed]); // recovery runs at the lower speed
+    }
+
+    reportFault();
+}
+
+bool TextLCD_I2C::scheduled() {
+    return _refresh_event || _fade_event || DisplayBase::scheduled();
+}
+
+bool TextLCD_I2C::beginBatch() {
+    _batch_depth++;
+
+    return true;
+}
+
+bool TextLCD_I2C::endBatch() {
+    flushBurst();
+    _batch_depth--;
+
+    return false;
+}
+
+void TextLCD_I2C::setBacklightBit(bool on) {
     if (_alt_pinmap) {
         _pins &= ~0b10000000;
         _pins |= !on << 7;
@@ -146,20 +387,59 @@ void TextLCD_I2C::setBacklight(bool on) {
         _pins &= ~0b1000;
         _pins |= on << 3;
     }
-
-    i2cWrite();
 }
 
 bool TextLCD_I2C::i2cWrite() {
     int32_t ack;
 
+    // sigma-delta modulation of the backlight bit, every write carries the next sample
+    _dither += _duty;
+    setBacklightBit(_dither >= BACKLIGHT_LEVELS);
+
+    if (_dither >= BACKLIGHT_LEVELS) {
+        _dither -= BACKLIGHT_LEVELS;
+    }
+    _traffic = true;
+
+    if (_batch_depth > 0) {
+        if (_burst_len == sizeof(_burst)) {
+            flushBurst();
+        }
+
+        _burst[_burst_len++] = _pins;
+        return true;
+    }
+
     _i2c->lock();
     ack = _i2c->write(_i2c_addr, &_pins, 1);
     _i2c->unlock();
 
     if (ack != 0) {
+        busError();
         return false;
     }
 
     return true;
-}
\ No newline at end of file
+}
+
+bool TextLCD_I2C::flushBurst() {
+    int32_t ack;
+
+    if (_burst_len == 0) {
+        return true;
+    }
+
+    // expander updates the outputs after each byte, every one of them is longer than the minimal E pulse
+    _i2c->lock();
+    ack = _i2c->write(_i2c_addr, _burst, _burst_len);
+    _i2c->unlock();
+
+    _burst_len = 0;
+
+    if (ack != 0) {
+        busError();
+        return false;
+    }
+
+    return true;
+}
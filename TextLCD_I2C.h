@@ -67,6 +67,17 @@ class TextLCD_I2C: public DisplayBase {
      */
     bool init(I2C *i2c_obj = nullptr, lcd_char_t chars = CHAR_5X8);
 
+    /**
+     * @brief Initialize display in the background
+     * Waits for the controller to power up, see power-on-delay in mbed_lib.json.
+     * Display stays bound to the event queue, see bind()
+     *
+     * @param done called from the event queue with true if success, false otherwise
+     * @param i2c_obj I2C object to pass
+     * @param chars Size of 1 character, can be 5x8 or 5x10 on some displays
+     */
+    void initAsync(Callback<void(bool)> done, I2C *i2c_obj = nullptr, lcd_char_t chars = CHAR_5X8);
+
     /**
      * @brief Set the backlight
      *
@@ -74,6 +85,44 @@ class TextLCD_I2C: public DisplayBase {
      */
     void setBacklight(bool on);
 
+    /**
+     * @brief Drive the backlight by PWM pin instead of the backpack bit
+     *
+     * @param pwm PwmOut object to pass, nullptr to use the backpack
+     */
+    void attachBacklight(PwmOut *pwm);
+
+    /**
+     * @brief Set the backlight brightness
+     * Without PWM pin the backlight is on for any level above 0, unless software PWM
+     * is enabled by backlight-pwm-interval in mbed_lib.json: the backpack bit is then
+     * dithered along with the display traffic and refreshed periodically when the bus is idle
+     *
+     * @param level 0.0 - 1.0 (perceived brightness)
+     */
+    void setBrightness(float level);
+
+    /**
+     * @brief Fade the backlight brightness in the background
+     *
+     * @param level target 0.0 - 1.0 (perceived brightness)
+     * @param duration time of the fade
+     */
+    void fadeBacklight(float level, Kernel::Clock::duration_u32 duration);
+
+    /**
+     * @brief Find the fastest bus speed the backpack handles reliably, call after init()
+     * Steps the bus clock up and reads a test pattern back at each speed.
+     * The speed is lowered a step later when bus errors pile up,
+     * see i2c-fallback-errors and i2c-fallback-window in mbed_lib.json.
+     * Frequency of the whole bus is changed, don't use when shared with slower devices
+     *
+     * @param max_frequency highest speed tried
+     *
+     * @return selected bus speed
+     */
+    uint32_t tuneFrequency(uint32_t max_frequency = 1000000);
+
   protected:
     uint8_t dataRead() override;
     void dataWrite(uint8_t pins) override;
@@ -82,18 +131,53 @@ class TextLCD_I2C: public DisplayBase {
     void rw(bool state) override;
 
     void initI2C(I2C *i2c_obj = nullptr);
+    void reset() override;
+    void powerSave(bool enable) override;
+    bool beginBatch() override;
+    bool endBatch() override;
+    bool scheduled() override;
 
   private:
-    I2C *_i2c;
+    static const uint32_t frequencies[5];
+
+    I2C *_i2c = nullptr;
     const int8_t _i2c_addr;
     const bool _alt_pinmap = false;
     char _pins = 0;
+    bool _backlight = false;
+    bool _asleep = false;
+    uint8_t _speed = 0; // index of the tuned frequency, 0 when not tuned
+    uint8_t _bus_errors = 0; // within the fallback window
+    Kernel::Clock::time_point _errors_since; // start of the fallback window
+
+    PwmOut *_pwm = nullptr;
+    uint8_t _level = 255; // perceived brightness
+    uint8_t _duty = 8; // out of BACKLIGHT_LEVELS
+    uint8_t _dither = 0;
+    bool _traffic = false;
+    int _refresh_event = 0;
+
+    uint8_t _fade_from = 0;
+    uint8_t _fade_to = 0;
+    uint16_t _fade_steps = 0;
+    uint16_t _fade_step = 0;
+    int _fade_event = 0;
+
+    uint8_t _batch_depth = 0;
+    char _burst[16]; // pin states of one bus operation, sent in one transfer
+    uint8_t _burst_len = 0;
     uint32_t _i2c_obj[sizeof(I2C) / sizeof(uint32_t)] = {0};
 
     bool i2cWrite();
+    bool flushBurst();
+    void busError();
+    void setBacklightBit(bool on);
+    void applyBrightness();
+    void backlightRefresh();
+    void fadeStep();
 
-    void dataInput() {};
-    void dataOutput() {};
+    void dataInput() override;
+    void dataOutput() override {};
 };
 
 #endif
@@ -0,0 +1,315 @@
+/*
+MIT License
+Copyright (c) 2021 Pavel Slama
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "TextLCD_MCP.h"
+
+// IODIR, IOCON, GPIO, OLAT; MCP23017 port A in IOCON.BANK = 1 has the same map as MCP23008
+const uint8_t TextLCD_MCP::registers[4] = {0x00, 0x05, 0x09, 0x0A};
+
+// IOCON of MCP23017 in IOCON.BANK = 0 (power-on default)
+#define MCP23017_IOCON_BANK0 0x0A
+
+TextLCD_MCP::TextLCD_MCP(mcp_type_t type, bool alt_pinmap, bool bf, lcd_size_t size, int8_t address,
+                         uint32_t frequency):
+    DisplayBase{size, bf && !alt_pinmap, !alt_pinmap},
+    _type(type),
+    _i2c_addr(address),
+    _alt_pinmap(alt_pinmap) {
+    setPad(frequency);
+}
+
+TextLCD_MCP::TextLCD_MCP(PinName sda, PinName scl, mcp_type_t type, bool alt_pinmap, bool bf, lcd_size_t size,
+                         int8_t address, uint32_t frequency):
+    DisplayBase{size, bf && !alt_pinmap, !alt_pinmap},
+    _type(type),
+    _i2c_addr(address),
+    _alt_pinmap(alt_pinmap) {
+    _i2c = new (_i2c_obj) I2C(sda, scl);
+    _i2c->frequency(frequency);
+    setPad(frequency);
+}
+
+TextLCD_MCP::~TextLCD_MCP() {
+    if (_i2c == reinterpret_cast<I2C *>(_i2c_obj)) {
+        _i2c->~I2C();
+    }
+}
+
+void TextLCD_MCP::setPad(uint32_t frequency) {
+    // one streamed byte takes 9 clocks, execution time is 37us
+    _pad = (40 * (frequency / 1000) + 8999) / 9000;
+
+    if (_pad == 0) {
+        _pad = 1;
+    }
+}
+
+void TextLCD_MCP::initMCP(I2C *i2c_obj) {
+    if (i2c_obj != nullptr) {
+        _i2c = i2c_obj;
+    }
+
+    MBED_ASSERT(_i2c);
+
+    if (_type == MCP23017) {
+        // in byte mode with BANK = 0 the pointer toggles between A and B registers, switch to BANK = 1;
+        // if already switched by a previous init this goes to OLATA with E low and is harmless
+        writeAddress(MCP23017_IOCON_BANK0, IOCON_BANK | IOCON_SEQOP);
+        writeRegister(REG_IOCON, IOCON_BANK | IOCON_SEQOP);
+
+    } else {
+        writeRegister(REG_IOCON, IOCON_SEQOP);
+    }
+
+    writeRegister(REG_IODIR, 0); // all outputs
+
+    dataWrite(0);
+    en(0);
+    rw(0);
+    setBacklight(0);
+}
+
+bool TextLCD_MCP::init(I2C *i2c_obj, lcd_char_t chars) {
+    initMCP(i2c_obj);
+    reset();
+
+    return DisplayBase::init(FONT_JAPANESE, chars);
+}
+
+void TextLCD_MCP::initAsync(Callback<void(bool)> done, I2C *i2c_obj, lcd_char_t chars) {
+    lock();
+
+    beginInit(done);
+    init(i2c_obj, chars);
+
+    unlock();
+}
+
+void TextLCD_MCP::reset() {
+    // Function Set
+    writeBits(0b11); // 8-bit mode
+    delay(5ms); // minimum 4.1ms
+
+    writeBits(0b0011); // 8-bit mode
+    delay(120us); // minimum 100us
+
+    // Function Set
+    writeBits(0b0011); // 8-bit mode
+}
+
+uint8_t TextLCD_MCP::dataRead() {
+    int32_t ack;
+    char buf[1] = {(char)registers[REG_GPIO]};
+
+    flushStream(); // enable has to be up before reading
+
+    _i2c->lock();
+    ack = _i2c->write(_i2c_addr, buf, 1, true);
+
+    if (ack == 0) {
+        ack = _i2c->read(_i2c_addr, buf, 1);
+    }
+
+    _i2c->unlock();
+
+    if (ack != 0) {
+        reportFault();
+        return 0;
+    }
+
+    return buf[0] >> 4;
+}
+
+void TextLCD_MCP::dataInput() {
+    flushStream();
+
+    _input = true;
+    writeRegister(REG_IODIR, 0b11110000);
+}
+
+void TextLCD_MCP::dataOutput() {
+    _input = false;
+    writeRegister(REG_IODIR, 0);
+}
+
+void TextLCD_MCP::dataWrite(uint8_t pins) {
+    if (_alt_pinmap) {
+        _pins &= ~0b01111000;
+        _pins |= (pins & 0b1111) << 3;
+
+    } else {
+        _pins &= ~0b11110000;
+        _pins |= (pins & 0b1111) << 4;
+    }
+
+    mcpWrite();
+}
+
+void TextLCD_MCP::en(bool state) {
+    _pins &= ~0b100;
+    _pins |= state << 2;
+
+    mcpWrite();
+}
+
+void TextLCD_MCP::rw(bool state) {
+    if (_alt_pinmap) { // tied to GND
+        return;
+    }
+
+    _pins &= ~0b10;
+    _pins |= state << 1;
+
+    mcpWrite();
+}
+
+void TextLCD_MCP::rs(bool state) {
+    if (_alt_pinmap) {
+        _pins &= ~0b10;
+        _pins |= state << 1;
+
+    } else {
+        _pins &= ~0b1;
+        _pins |= state;
+    }
+
+    mcpWrite();
+}
+
+void TextLCD_MCP::setBacklight(bool on) {
+    lock();
+    activity();
+
+    _backlight = on;
+    updateBacklight();
+
+    unlock();
+}
+
+void TextLCD_MCP::powerSave(bool enable) {
+    DisplayBase::powerSave(enable);
+
+    _asleep = enable;
+    updateBacklight();
+}
+
+void TextLCD_MCP::updateBacklight() {
+    bool on = _backlight && !_asleep;
+
+    if (_alt_pinmap) {
+        _pins &= ~0b10000000;
+        _pins |= on << 7;
+
+    } else {
+        _pins &= ~0b1000;
+        _pins |= on << 3;
+    }
+
+    if (_i2c && !offline()) {
+        mcpWrite();
+    }
+}
+
+bool TextLCD_MCP::beginBatch() {
+    _batch_depth++;
+
+    return true;
+}
+
+bool TextLCD_MCP::endBatch() {
+    _batch_depth--;
+
+    if (_batch_depth == 0 || _input) {
+        flushStream();
+        return false;
+    }
+
+    // keep streaming, the same state repeated gives the display time to execute
+    for (auto i = 0; i < _pad; i++) {
+        mcpWrite(true);
+    }
+
+    return true;
+}
+
+void TextLCD_MCP::flushBatch() {
+    flushStream();
+}
+
+bool TextLCD_MCP::writeRegister(mcp_register_t reg, uint8_t value) {
+    return writeAddress(registers[reg], value);
+}
+
+bool TextLCD_MCP::writeAddress(uint8_t address, uint8_t value) {
+    int32_t ack;
+    char buf[2] = {(char)address, (char)value};
+
+    _i2c->lock();
+    ack = _i2c->write(_i2c_addr, buf, 2);
+    _i2c->unlock();
+
+    if (ack != 0) {
+        reportFault();
+        return false;
+    }
+
+    return true;
+}
+
+void TextLCD_MCP::mcpWrite(bool repeat) {
+    if (_batch_depth == 0 || _input) {
+        writeRegister(REG_OLAT, _pins);
+        return;
+    }
+
+    if (!repeat && _stream_len > 0 && _stream[_stream_len] == _pins) { // nothing changed
+        return;
+    }
+
+    if (_stream_len == sizeof(_stream) - 1) {
+        flushStream();
+    }
+
+    _stream[++_stream_len] = _pins;
+}
+
+bool TextLCD_MCP::flushStream() {
+    int32_t ack;
+
+    if (_stream_len == 0) {
+        return true;
+    }
+
+    // SEQOP keeps the address at OLAT, outputs change after each byte
+    _stream[0] = registers[REG_OLAT];
+
+    _i2c->lock();
+    ack = _i2c->write(_i2c_addr, _stream, _stream_len + 1);
+    _i2c->unlock();
+
+    _stream_len = 0;
+
+    if (ack != 0) {
+        reportFault();
+        return false;
+    }
+
+    return true;
+}
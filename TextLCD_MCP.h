@@ -0,0 +1,153 @@
+/*
+MIT License
+Copyright (c) 2021 Pavel Slama
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef TEXT_LCD_MCP_H
+#define TEXT_LCD_MCP_H
+
+#define TEXT_DISPLAY_MCP_ADDRESS (0x20 << 1)
+
+#include "DisplayBase.h"
+
+/**
+ * MCP23008 GP0-GP7 / MCP23017 GPA0-GPA7:
+ * GP0 - RS, GP1 - RW, GP2 - E, GP3 - backlight, GP4-GP7 - D4-D7 (same as PCF8574 backpack)
+ * alternative: GP1 - RS, GP2 - E, GP3-GP6 - D4-D7, GP7 - backlight, RW to GND (Adafruit backpack)
+ */
+class TextLCD_MCP: public DisplayBase {
+  public:
+    enum mcp_type_t {
+        MCP23008,
+        MCP23017
+    };
+
+    /**
+     * @brief Create an I2C LCD interface
+     *
+     * @param type Expander used
+     * @param alt_pinmap Alternative pin maping
+     * @param bf Set to true if busy flag should be used, needs RW connected
+     * @param size Panel size
+     * @param address 7-bit I2C address of the expander
+     * @param frequency speed of the I2C object passed to init(), used for spacing of the streamed writes
+     */
+    TextLCD_MCP(mcp_type_t type = MCP23008, bool alt_pinmap = false, bool bf = false, lcd_size_t size = SIZE_16x2,
+                int8_t address = TEXT_DISPLAY_MCP_ADDRESS, uint32_t frequency = 400000);
+
+    /**
+     * @brief Create an I2C LCD interface
+     *
+     * @param sda SDA pin
+     * @param scl SCL pin
+     * @param type Expander used
+     * @param alt_pinmap Alternative pin maping
+     * @param bf Set to true if busy flag should be used, needs RW connected
+     * @param size Panel size
+     * @param address 7-bit I2C address of the expander
+     * @param frequency I2C bus speed
+     */
+    TextLCD_MCP(PinName sda, PinName scl, mcp_type_t type = MCP23008, bool alt_pinmap = false, bool bf = false,
+                lcd_size_t size = SIZE_16x2, int8_t address = TEXT_DISPLAY_MCP_ADDRESS, uint32_t frequency = 400000);
+
+    /**
+     * @brief Destructor
+     *
+     */
+    ~TextLCD_MCP();
+
+    /**
+     * @brief Initialize display
+     *
+     * @param i2c_obj I2C object to pass
+     * @param chars Size of 1 character, can be 5x8 or 5x10 on some displays
+     *
+     * @return true if success, false otherwise
+     */
+    bool init(I2C *i2c_obj = nullptr, lcd_char_t chars = CHAR_5X8);
+
+    /**
+     * @brief Initialize display in the background
+     * Waits for the controller to power up, see power-on-delay in mbed_lib.json.
+     * Display stays bound to the event queue, see bind()
+     *
+     * @param done called from the event queue with true if success, false otherwise
+     * @param i2c_obj I2C object to pass
+     * @param chars Size of 1 character, can be 5x8 or 5x10 on some displays
+     */
+    void initAsync(Callback<void(bool)> done, I2C *i2c_obj = nullptr, lcd_char_t chars = CHAR_5X8);
+
+    /**
+     * @brief Set the backlight
+     *
+     * @param on
+     */
+    void setBacklight(bool on);
+
+  protected:
+    uint8_t dataRead() override;
+    void dataWrite(uint8_t pins) override;
+    void dataInput() override;
+    void dataOutput() override;
+    void en(bool state) override;
+    void rs(bool state) override;
+    void rw(bool state) override;
+
+    void initMCP(I2C *i2c_obj = nullptr);
+    void reset() override;
+    void powerSave(bool enable) override;
+    bool beginBatch() override;
+    bool endBatch() override;
+    void flushBatch() override;
+
+  private:
+    enum mcp_register_t {
+        REG_IODIR,
+        REG_IOCON,
+        REG_GPIO,
+        REG_OLAT
+    };
+
+    static const uint8_t IOCON_BANK = 0b10000000; // MCP23017 registers of each port together
+    static const uint8_t IOCON_SEQOP = 0b100000; // address pointer doesn't increment
+    static const uint8_t registers[4];
+
+    I2C *_i2c = nullptr;
+    const mcp_type_t _type;
+    const int8_t _i2c_addr;
+    const bool _alt_pinmap = false;
+    uint8_t _pad = 1; // writes taking execution time of the display
+    char _pins = 0;
+    bool _backlight = false;
+    bool _asleep = false;
+    bool _input = false;
+
+    uint8_t _batch_depth = 0;
+    char _stream[33]; // register followed by pin states, sent in one transfer
+    uint8_t _stream_len = 0;
+    uint32_t _i2c_obj[sizeof(I2C) / sizeof(uint32_t)] = {0};
+
+    bool writeRegister(mcp_register_t reg, uint8_t value);
+    bool writeAddress(uint8_t address, uint8_t value);
+    void mcpWrite(bool repeat = false);
+    bool flushStream();
+    void updateBacklight();
+    void setPad(uint32_t frequency);
+};
+
+#endif
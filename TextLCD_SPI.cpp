@@ -0,0 +1,186 @@
+/*
+MIT License
+Copyright (c) 2021 Pavel Slama
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "TextLCD_SPI.h"
+
+TextLCD_SPI::TextLCD_SPI(PinName latch, lcd_size_t size):
+    DisplayBase{size, false},
+    _latch(latch, 1) {
+}
+
+TextLCD_SPI::TextLCD_SPI(PinName mosi, PinName sclk, PinName latch, lcd_size_t size, uint32_t frequency):
+    DisplayBase{size, false},
+    _latch(latch, 1) {
+    _spi = new (_spi_obj) SPI(mosi, NC, sclk);
+    _spi->format(8, 0);
+    _spi->frequency(frequency);
+}
+
+TextLCD_SPI::~TextLCD_SPI() {
+    if (_spi == reinterpret_cast<SPI *>(_spi_obj)) {
+        _spi->~SPI();
+    }
+}
+
+void TextLCD_SPI::initSPI(SPI *spi_obj) {
+    if (spi_obj != nullptr) {
+        _spi = spi_obj;
+    }
+
+    MBED_ASSERT(_spi);
+
+    dataWrite(0);
+    en(0);
+    rw(0); // can't read through the shift register
+    setBacklight(0);
+}
+
+bool TextLCD_SPI::init(SPI *spi_obj, lcd_char_t chars) {
+    initSPI(spi_obj);
+    reset();
+
+    return DisplayBase::init(FONT_JAPANESE, chars);
+}
+
+void TextLCD_SPI::initAsync(Callback<void(bool)> done, SPI *spi_obj, lcd_char_t chars) {
+    lock();
+
+    beginInit(done);
+    init(spi_obj, chars);
+
+    unlock();
+}
+
+void TextLCD_SPI::reset() {
+    // Function Set
+    writeBits(0b11); // 8-bit mode
+    delay(5ms); // minimum 4.1ms
+
+    writeBits(0b0011); // 8-bit mode
+    delay(120us); // minimum 100us
+
+    // Function Set
+    writeBits(0b0011); // 8-bit mode
+}
+
+void TextLCD_SPI::dataWrite(uint8_t pins) {
+    _pins &= ~0b11110000;
+    _pins |= (pins & 0b1111) << 4;
+
+    spiWrite();
+}
+
+void TextLCD_SPI::en(bool state) {
+    _pins &= ~0b100;
+    _pins |= state << 2;
+
+    spiWrite();
+}
+
+void TextLCD_SPI::rw(bool state) {
+    _pins &= ~0b10;
+    _pins |= state << 1;
+
+    spiWrite();
+}
+
+void TextLCD_SPI::rs(bool state) {
+    _pins &= ~0b1;
+    _pins |= state;
+
+    spiWrite();
+}
+
+void TextLCD_SPI::setBacklight(bool on) {
+    lock();
+    activity();
+
+    _backlight = on;
+    _pins &= ~0b1000;
+    _pins |= (_backlight && !_asleep) << 3;
+
+    if (_spi) {
+        spiWrite();
+    }
+
+    unlock();
+}
+
+void TextLCD_SPI::powerSave(bool enable) {
+    DisplayBase::powerSave(enable);
+
+    _asleep = enable;
+    _pins &= ~0b1000;
+    _pins |= (_backlight && !_asleep) << 3;
+    spiWrite();
+}
+
+bool TextLCD_SPI::beginBatch() {
+    _batch_depth++;
+
+    return true;
+}
+
+bool TextLCD_SPI::endBatch() {
+    // SPI is too fast to space the next operation, send right away
+    flushBurst();
+    _batch_depth--;
+
+    return false;
+}
+
+void TextLCD_SPI::spiWrite() {
+    if (_batch_depth > 0) {
+        if (_burst_len > 0 && _burst[_burst_len - 1] == _pins) { // nothing changed
+            return;
+        }
+
+        if (_burst_len == sizeof(_burst)) {
+            flushBurst();
+        }
+
+        _burst[_burst_len++] = _pins;
+        return;
+    }
+
+    _spi->lock();
+    _latch = 0;
+    _spi->write(_pins);
+    _latch = 1;
+    _spi->unlock();
+}
+
+void TextLCD_SPI::flushBurst() {
+    if (_burst_len == 0) {
+        return;
+    }
+
+    // every state needs its own latch edge, a byte at several MHz is longer than the minimal E pulse
+    _spi->lock();
+
+    for (auto i = 0; i < _burst_len; i++) {
+        _latch = 0;
+        _spi->write(_burst[i]);
+        _latch = 1;
+    }
+
+    _spi->unlock();
+    _burst_len = 0;
+}
@@ -0,0 +1,120 @@
+/*
+MIT License
+Copyright (c) 2021 Pavel Slama
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef TEXT_LCD_SPI_H
+#define TEXT_LCD_SPI_H
+
+#include "DisplayBase.h"
+
+/**
+ * 74HC595 outputs: Q0 - RS, Q1 - RW, Q2 - E, Q3 - backlight, Q4-Q7 - D4-D7
+ * (same as PCF8574 backpack), RCLK is the latch pin
+ */
+class TextLCD_SPI: public DisplayBase {
+  public:
+    /**
+     * @brief Create an SPI LCD interface
+     *
+     * @param latch Storage register clock (RCLK) pin
+     * @param size Panel size
+     */
+    TextLCD_SPI(PinName latch, lcd_size_t size = SIZE_16x2);
+
+    /**
+     * @brief Create an SPI LCD interface
+     *
+     * @param mosi MOSI pin
+     * @param sclk SCLK pin
+     * @param latch Storage register clock (RCLK) pin
+     * @param size Panel size
+     * @param frequency SPI bus speed
+     */
+    TextLCD_SPI(PinName mosi, PinName sclk, PinName latch, lcd_size_t size = SIZE_16x2,
+                uint32_t frequency = 4000000);
+
+    /**
+     * @brief Destructor
+     *
+     */
+    ~TextLCD_SPI();
+
+    /**
+     * @brief Initialize display
+     *
+     * @param spi_obj SPI object to pass
+     * @param chars Size of 1 character, can be 5x8 or 5x10 on some displays
+     *
+     * @return true if success, false otherwise
+     */
+    bool init(SPI *spi_obj = nullptr, lcd_char_t chars = CHAR_5X8);
+
+    /**
+     * @brief Initialize display in the background
+     * Waits for the controller to power up, see power-on-delay in mbed_lib.json.
+     * Display stays bound to the event queue, see bind()
+     *
+     * @param done called from the event queue with true if success, false otherwise
+     * @param spi_obj SPI object to pass
+     * @param chars Size of 1 character, can be 5x8 or 5x10 on some displays
+     */
+    void initAsync(Callback<void(bool)> done, SPI *spi_obj = nullptr, lcd_char_t chars = CHAR_5X8);
+
+    /**
+     * @brief Set the backlight
+     *
+     * @param on
+     */
+    void setBacklight(bool on);
+
+  protected:
+    void dataWrite(uint8_t pins) override;
+    void en(bool state) override;
+    void rs(bool state) override;
+    void rw(bool state) override;
+
+    void initSPI(SPI *spi_obj = nullptr);
+    void reset() override;
+    void powerSave(bool enable) override;
+    bool beginBatch() override;
+    bool endBatch() override;
+
+  private:
+    SPI *_spi = nullptr;
+    DigitalOut _latch;
+    char _pins = 0;
+    bool _backlight = false;
+    bool _asleep = false;
+
+    uint8_t _batch_depth = 0;
+    char _burst[16]; // pin states of one bus operation
+    uint8_t _burst_len = 0;
+    uint32_t _spi_obj[sizeof(SPI) / sizeof(uint32_t)] = {0};
+
+    void spiWrite();
+    void flushBurst();
+
+    uint8_t dataRead() override {
+        return 0;
+    };
+    void dataInput() override {};
+    void dataOutput() override {};
+};
+
+#endif
@@ -0,0 +1,76 @@
+/*
+MIT License
+Copyright (c) 2021 Pavel Slama
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "TextLCD_ST7032.h"
+
+TextLCD_ST7032::TextLCD_ST7032(lcd_size_t size, int8_t address, uint32_t frequency):
+    DisplayI2C{size, address, frequency} {
+}
+
+TextLCD_ST7032::TextLCD_ST7032(PinName sda, PinName scl, lcd_size_t size, int8_t address, uint32_t frequency):
+    DisplayI2C{sda, scl, size, address, frequency} {
+}
+
+bool TextLCD_ST7032::init(I2C *i2c_obj, uint8_t contrast) {
+    initI2C(i2c_obj);
+    _contrast = contrast & 0b111111;
+
+    return DisplayBase::init(FONT_JAPANESE, CHAR_5X8);
+}
+
+void TextLCD_ST7032::initAsync(Callback<void(bool)> done, I2C *i2c_obj, uint8_t contrast) {
+    lock();
+
+    beginInit(done);
+    init(i2c_obj, contrast);
+
+    unlock();
+}
+
+void TextLCD_ST7032::functionSet() {
+    uint8_t function = CMD_FUNCTION_SET | FN_8BIT_MODE | (rows() > 1 ? FN_2LINE : FN_1LINE);
+
+    writeCommand(function);
+    writeCommand(function | CMD_INSTRUCTION_TABLE);
+    writeCommand(CMD_OSC_FREQUENCY);
+    writeContrast();
+    writeCommand(CMD_FOLLOWER);
+    delay(200ms); // voltage follower has to settle
+
+    writeCommand(function);
+}
+
+void TextLCD_ST7032::setContrast(uint8_t contrast) {
+    lock();
+    activity();
+
+    _contrast = contrast & 0b111111;
+
+    writeCommand(CMD_FUNCTION_SET | FN_8BIT_MODE | (rows() > 1 ? FN_2LINE : FN_1LINE) | CMD_INSTRUCTION_TABLE);
+    writeContrast();
+    writeCommand(CMD_FUNCTION_SET | FN_8BIT_MODE | (rows() > 1 ? FN_2LINE : FN_1LINE));
+
+    unlock();
+}
+
+void TextLCD_ST7032::writeContrast() {
+    writeCommand(CMD_CONTRAST | (_contrast & 0b1111));
+    writeCommand(CMD_POWER_ICON | (_contrast >> 4));
+}
@@ -0,0 +1,100 @@
+/*
+MIT License
+Copyright (c) 2021 Pavel Slama
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef TEXT_LCD_ST7032_H
+#define TEXT_LCD_ST7032_H
+
+#define TEXT_DISPLAY_ST7032_ADDRESS (0x3E << 1)
+
+#include "DisplayI2C.h"
+
+/**
+ * ST7032i controller with native I2C interface, booster and contrast set for 3.3V supply
+ */
+class TextLCD_ST7032: public DisplayI2C {
+  public:
+    /**
+     * @brief Create an ST7032i LCD interface
+     *
+     * @param size Panel size
+     * @param address 7-bit I2C address of the controller
+     * @param frequency speed of the I2C object passed to init(), used for spacing of the streamed writes
+     */
+    TextLCD_ST7032(lcd_size_t size = SIZE_16x2, int8_t address = TEXT_DISPLAY_ST7032_ADDRESS,
+                   uint32_t frequency = 400000);
+
+    /**
+     * @brief Create an ST7032i LCD interface
+     *
+     * @param sda SDA pin
+     * @param scl SCL pin
+     * @param size Panel size
+     * @param address 7-bit I2C address of the controller
+     * @param frequency I2C bus speed
+     */
+    TextLCD_ST7032(PinName sda, PinName scl, lcd_size_t size = SIZE_16x2,
+                   int8_t address = TEXT_DISPLAY_ST7032_ADDRESS, uint32_t frequency = 400000);
+
+    /**
+     * @brief Initialize display
+     *
+     * @param i2c_obj I2C object to pass
+     * @param contrast 0-63
+     *
+     * @return true if success, false otherwise
+     */
+    bool init(I2C *i2c_obj = nullptr, uint8_t contrast = 32);
+
+    /**
+     * @brief Initialize display in the background
+     * Waits for the controller to power up, see power-on-delay in mbed_lib.json.
+     * Display stays bound to the event queue, see bind()
+     *
+     * @param done called from the event queue with true if success, false otherwise
+     * @param i2c_obj I2C object to pass
+     * @param contrast 0-63
+     */
+    void initAsync(Callback<void(bool)> done, I2C *i2c_obj = nullptr, uint8_t contrast = 32);
+
+    /**
+     * @brief Set the contrast
+     *
+     * @param contrast 0-63
+     */
+    void setContrast(uint8_t contrast);
+
+  protected:
+    void functionSet() override;
+
+  private:
+    enum st7032_command_t { // extended instruction table, IS = 1
+        CMD_INSTRUCTION_TABLE = 0b1,
+        CMD_OSC_FREQUENCY     = 0b10100, // bias 1/5, 183Hz
+        CMD_POWER_ICON        = 0b1010100, // booster on, C5-C4 follow
+        CMD_FOLLOWER          = 0b1101100, // follower on, amplified ratio 4
+        CMD_CONTRAST          = 0b1110000 // C3-C0 follow
+    };
+
+    uint8_t _contrast = 32;
+
+    void writeContrast();
+};
+
+#endif
@@ -26,10 +26,34 @@ TextOLED::TextOLED(PinName rs, PinName en, PinName d4, PinName d5, PinName d6, P
 }
 
 bool TextOLED::init(lcd_font_t font, lcd_char_t chars) {
+    reset();
+
+    return DisplayBase::init(font, chars);
+}
+
+void TextOLED::initAsync(Callback<void(bool)> done, lcd_font_t font, lcd_char_t chars) {
+    lock();
+
+    beginInit(done);
+    init(font, chars);
+
+    unlock();
+}
+
+void TextOLED::reset() {
     // Synchronization function for an 4-bit bus
     for (auto i = 0; i < 5; i++) {
         writeBits(0b0000);
     }
+}
 
-    return DisplayBase::init(font, chars);
+void TextOLED::powerSave(bool enable) {
+    if (enable) {
+        DisplayBase::powerSave(true);
+        writeCommand(CMD_CURSOR_SHIFT | MODE_CHARACTER); // internal power off
+
+    } else {
+        writeCommand(CMD_CURSOR_SHIFT | MODE_CHARACTER | MODE_POWER_ON);
+        DisplayBase::powerSave(false);
+    }
 }
@@ -33,11 +33,34 @@ TextOLED_I2C::TextOLED_I2C(PinName sda, PinName scl, bool alt_pinmap, lcd_size_t
 
 bool TextOLED_I2C::init(I2C *i2c_obj, lcd_font_t font, lcd_char_t chars) {
     initI2C(i2c_obj);
+    reset();
 
+    return DisplayBase::init(font, chars);
+}
+
+void TextOLED_I2C::initAsync(Callback<void(bool)> done, I2C *i2c_obj, lcd_font_t font, lcd_char_t chars) {
+    lock();
+
+    beginInit(done);
+    init(i2c_obj, font, chars);
+
+    unlock();
+}
+
+void TextOLED_I2C::reset() {
     // Synchronization function for an 4-bit bus
     for (auto i = 0; i < 5; i++) {
         writeBits(0b0000);
     }
+}
 
-    return DisplayBase::init(font, chars);
+void TextOLED_I2C::powerSave(bool enable) {
+    if (enable) {
+        DisplayBase::powerSave(true);
+        writeCommand(CMD_CURSOR_SHIFT | MODE_CHARACTER); // internal power off
+
+    } else {
+        writeCommand(CMD_CURSOR_SHIFT | MODE_CHARACTER | MODE_POWER_ON);
+        DisplayBase::powerSave(false);
+    }
 }
@@ -59,6 +59,23 @@ class TextOLED_I2C: public TextLCD_I2C {
      * @return true if success, false otherwise
      */
     bool init(I2C *i2c_obj = nullptr, lcd_font_t font = FONT_JAPANESE, lcd_char_t chars = CHAR_5X8);
+
+    /**
+     * @brief Initialize display in the background
+     * Waits for the controller to power up, see power-on-delay in mbed_lib.json.
+     * Display stays bound to the event queue, see bind()
+     *
+     * @param done called from the event queue with true if success, false otherwise
+     * @param i2c_obj I2C object to pass
+     * @param font Font table used
+     * @param chars Size of 1 character, can be 5x8 or 5x10 on some displays
+     */
+    void initAsync(Callback<void(bool)> done, I2C *i2c_obj = nullptr, lcd_font_t font = FONT_JAPANESE,
+                   lcd_char_t chars = CHAR_5X8);
+
+  protected:
+    void reset() override;
+    void powerSave(bool enable) override;
 };
 
 #endif
@@ -0,0 +1,187 @@
+/*
+MIT License
+Copyright (c) 2021 Pavel Slama
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "TextOLED_US2066.h"
+
+TextOLED_US2066::TextOLED_US2066(lcd_size_t size, int8_t address, uint32_t frequency):
+    DisplayI2C{size, address, frequency} {
+}
+
+TextOLED_US2066::TextOLED_US2066(PinName sda, PinName scl, lcd_size_t size, int8_t address, uint32_t frequency):
+    DisplayI2C{sda, scl, size, address, frequency} {
+}
+
+bool TextOLED_US2066::init(I2C *i2c_obj, bool regulator) {
+    initI2C(i2c_obj);
+    _regulator = regulator;
+
+    return DisplayBase::init(FONT_JAPANESE, CHAR_5X8);
+}
+
+void TextOLED_US2066::initAsync(Callback<void(bool)> done, I2C *i2c_obj, bool regulator) {
+    lock();
+
+    beginInit(done);
+    init(i2c_obj, regulator);
+
+    unlock();
+}
+
+void TextOLED_US2066::functionSet() {
+    uint8_t function = CMD_FUNCTION_SET | (rows() > 1 ? FN_2LINE : FN_1LINE);
+
+    writeCommand(function | CMD_EXTENDED_SET);
+    writeCommand(CMD_FUNCTION_A);
+    writeData(_regulator ? 0x5C : 0);
+
+    writeCommand(CMD_EXTENDED_FUNCTION | (rows() > 2 ? EXT_FN_4LINE : 0));
+    writeCommand(CMD_ENTRY_DIRECTION);
+    writeCommand(CMD_FUNCTION_B);
+    writeData(0); // ROM A, 8 CGRAM characters
+
+    writeCommand(CMD_OLED_SET_ON);
+    writeCommand(CMD_CLOCK);
+    writeCommand(0x70);
+    writeCommand(CMD_SEG_PINS);
+    writeCommand(0x10); // alternative SEG pin configuration
+    writeCommand(CMD_FUNCTION_C);
+    writeCommand(0); // internal VSL
+    writeCommand(CMD_CONTRAST);
+    writeCommand(_contrast);
+    writeCommand(CMD_PHASE);
+    writeCommand(0xF1);
+    writeCommand(CMD_VCOMH);
+    writeCommand(0x40);
+    writeCommand(CMD_OLED_SET_OFF);
+
+    writeCommand(function);
+}
+
+void TextOLED_US2066::setContrast(uint8_t contrast) {
+    uint8_t function = CMD_FUNCTION_SET | (rows() > 1 ? FN_2LINE : FN_1LINE);
+
+    lock();
+    activity();
+
+    _contrast = contrast;
+
+    writeCommand(function | CMD_EXTENDED_SET);
+    writeCommand(CMD_OLED_SET_ON);
+    writeCommand(CMD_CONTRAST);
+    writeCommand(_contrast);
+    writeCommand(CMD_OLED_SET_OFF);
+    writeCommand(function);
+
+    unlock();
+}
+
+void TextOLED_US2066::rs(bool state) {
+    _data = state;
+    DisplayI2C::rs(state);
+}
+
+void TextOLED_US2066::writeByte(uint8_t value) {
+    if (rows() < 4) {
+        DisplayI2C::writeByte(value);
+        return;
+    }
+
+    if (_data) {
+        if (!_extended && !_cgram) {
+            uint8_t counter = lineAddress(_address);
+
+            // lines aren't adjacent in 4-line mode, the counter runs off the end of the line,
+            // the address goes in the same stream spaced by the control byte (bus up to 400 kHz)
+            if (_counter != counter) {
+                DisplayI2C::rs(false);
+                DisplayI2C::writeByte(CMD_SET_DDRAM_ADDR | counter);
+                DisplayI2C::rs(true);
+            }
+
+            _address = nextAddress(_address, _increment);
+            _counter = (counter + (_increment ? 1 : -1)) & 0x7F;
+        }
+
+        DisplayI2C::writeByte(value);
+        return;
+    }
+
+    if (_oled) { // two-byte commands until OLED characterization is left
+        if (_argument) {
+            _argument = false;
+
+        } else if (value == CMD_OLED_SET_OFF) {
+            _oled = false;
+
+        } else if (value != CMD_OLED_SET_ON) {
+            _argument = true;
+        }
+
+    } else if ((value & 0b11100000) == CMD_FUNCTION_SET) {
+        _extended = value & CMD_EXTENDED_SET;
+
+    } else if (_extended) {
+        _oled = value == CMD_OLED_SET_ON;
+
+    } else if (value & CMD_SET_DDRAM_ADDR) {
+        _cgram = false;
+        _address = value & 0x7F;
+        _counter = lineAddress(_address);
+        value = CMD_SET_DDRAM_ADDR | _counter;
+
+    } else if (value & CMD_SET_CGRAM_ADDR) {
+        _cgram = true;
+
+    } else if ((value & 0b11111000) == (CMD_CURSOR_SHIFT | CURSOR_MOVE)) {
+        bool right = value & MOVE_RIGHT;
+
+        _address = nextAddress(_address, right);
+        _counter = (_counter + (right ? 1 : -1)) & 0x7F;
+
+    } else if ((value & 0b11111100) == CMD_ENTRY_MODE_SET) {
+        _increment = value & ENTRY_MODE_INCREMENT;
+
+    } else if ((value & 0b11111100) == 0 && value) { // clear or home
+        _cgram = false;
+        _address = 0;
+        _counter = 0;
+        _increment = _increment || value == CMD_CLEAR_DISPLAY;
+    }
+
+    DisplayI2C::writeByte(value);
+}
+
+uint8_t TextOLED_US2066::lineAddress(uint8_t address) {
+    // HD44780 20x4 has the lines 0 and 2, 1 and 3 one after another
+    if (address < 0x14) {
+        return address;
+
+    } else if (address < 0x28) {
+        return 0x40 + address - 0x14;
+
+    } else if (address >= 0x40 && address < 0x54) {
+        return 0x20 + address - 0x40;
+
+    } else if (address >= 0x54 && address < 0x68) {
+        return 0x60 + address - 0x54;
+    }
+
+    return address;
+}
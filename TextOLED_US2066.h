@@ -0,0 +1,123 @@
+/*
+MIT License
+Copyright (c) 2021 Pavel Slama
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef TEXT_OLED_US2066_H
+#define TEXT_OLED_US2066_H
+
+#define TEXT_DISPLAY_US2066_ADDRESS (0x3C << 1)
+
+#include "DisplayI2C.h"
+
+/**
+ * US2066 / SSD1311 controller with native I2C interface, character ROM A
+ * The lines of 4-line mode start at 0x00, 0x20, 0x40, 0x60, the addresses of a HD44780 20x4 are translated
+ */
+class TextOLED_US2066: public DisplayI2C {
+  public:
+    /**
+     * @brief Create an US2066 OLED interface
+     *
+     * @param size Panel size
+     * @param address 7-bit I2C address of the controller, SA0 high is 0x3D
+     * @param frequency speed of the I2C object passed to init(), used for spacing of the streamed writes
+     */
+    TextOLED_US2066(lcd_size_t size = SIZE_16x2, int8_t address = TEXT_DISPLAY_US2066_ADDRESS,
+                    uint32_t frequency = 400000);
+
+    /**
+     * @brief Create an US2066 OLED interface
+     *
+     * @param sda SDA pin
+     * @param scl SCL pin
+     * @param size Panel size
+     * @param address 7-bit I2C address of the controller, SA0 high is 0x3D
+     * @param frequency I2C bus speed
+     */
+    TextOLED_US2066(PinName sda, PinName scl, lcd_size_t size = SIZE_16x2,
+                    int8_t address = TEXT_DISPLAY_US2066_ADDRESS, uint32_t frequency = 400000);
+
+    /**
+     * @brief Initialize display
+     *
+     * @param i2c_obj I2C object to pass
+     * @param regulator Enable internal VDD regulator, for 3.3V supply
+     *
+     * @return true if success, false otherwise
+     */
+    bool init(I2C *i2c_obj = nullptr, bool regulator = true);
+
+    /**
+     * @brief Initialize display in the background
+     * Waits for the controller to power up, see power-on-delay in mbed_lib.json.
+     * Display stays bound to the event queue, see bind()
+     *
+     * @param done called from the event queue with true if success, false otherwise
+     * @param i2c_obj I2C object to pass
+     * @param regulator Enable internal VDD regulator, for 3.3V supply
+     */
+    void initAsync(Callback<void(bool)> done, I2C *i2c_obj = nullptr, bool regulator = true);
+
+    /**
+     * @brief Set the contrast
+     *
+     * @param contrast 0-255
+     */
+    void setContrast(uint8_t contrast);
+
+  protected:
+    void functionSet() override;
+    void writeByte(uint8_t value) override;
+    void rs(bool state) override;
+
+  private:
+    enum us2066_command_t {
+        CMD_EXTENDED_SET      = 0b10, // RE, function set
+        CMD_FUNCTION_A        = 0b1110001, // RE = 1, data follows
+        CMD_FUNCTION_B        = 0b1110010, // RE = 1, data follows
+        CMD_OLED_SET_OFF      = 0b1111000, // RE = 1, SD = 0
+        CMD_OLED_SET_ON       = 0b1111001, // RE = 1, SD = 1
+        CMD_EXTENDED_FUNCTION = 0b1000, // RE = 1, 5-dot font, 1 or 2 lines
+        EXT_FN_4LINE          = 0b1, // NW, 3 or 4 lines
+        CMD_ENTRY_DIRECTION   = 0b110, // RE = 1, COM0 -> COM31, SEG99 -> SEG0
+        CMD_CLOCK             = 0xD5, // SD = 1, value follows
+        CMD_SEG_PINS          = 0xDA,
+        CMD_FUNCTION_C        = 0xDC,
+        CMD_CONTRAST          = 0x81,
+        CMD_PHASE             = 0xD9,
+        CMD_VCOMH             = 0xDB
+    };
+
+    uint8_t _contrast = 0x7F;
+    bool _regulator = true;
+
+    // instruction set state followed for the address translation
+    bool _data = false;
+    bool _extended = false; // RE
+    bool _oled = false; // SD, commands take an argument
+    bool _argument = false;
+    bool _cgram = false;
+    bool _increment = true;
+    uint8_t _address = 0; // as seen by DisplayBase, HD44780 20x4 layout
+    uint8_t _counter = 0; // in the controller
+
+    static uint8_t lineAddress(uint8_t address);
+};
+
+#endif
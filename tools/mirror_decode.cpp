@@ -0,0 +1,197 @@
+/*
+MIT License
+Copyright (c) 2021 Pavel Slama
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * Host tool, rebuilds the screen from the stream sent by DisplayBase::setMirror()
+ *
+ * Build: g++ -std=c++11 -O2 -o mirror_decode mirror_decode.cpp
+ * Usage: mirror_decode [-q] [-g] [file|tty|-]
+ *
+ * Prints the screen after each update (only the last one with -q), -g adds the CGRAM glyphs.
+ * Waits for the header, so it can be attached to a serial port before setMirror() is called.
+ * CGRAM characters are shown as digits 0-7, other non-ASCII codes as '.'
+ * A tty is switched to raw mode so the binary records pass unchanged, the baud rate is kept (set it by stty)
+ */
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <termios.h>
+#include <unistd.h>
+
+enum mirror_record_t { // same as DisplayBase
+    MIRROR_GLYPH = 0xF0,
+    MIRROR_END   = 0xFF
+};
+
+struct screen_t {
+    uint8_t columns = 0;
+    uint8_t rows = 0;
+    uint8_t cells[80];
+    uint8_t cgram[64];
+    unsigned long updates = 0;
+    unsigned long bytes = 0;
+};
+
+static void print(const screen_t &screen, bool glyphs) {
+    printf("update %lu, %lu bytes\n", screen.updates, screen.bytes);
+
+    for (auto row = 0; row < screen.rows; row++) {
+        putchar('|');
+
+        for (auto column = 0; column < screen.columns; column++) {
+            uint8_t c = screen.cells[row * screen.columns + column];
+            putchar(c < 16 ? '0' + (c & 0b111) : (c < 0x20 || c > 0x7E) ? '.' : c);
+        }
+
+        printf("|\n");
+    }
+
+    if (!glyphs) {
+        return;
+    }
+
+    for (auto line = 0; line < 8; line++) {
+        for (auto location = 0; location < 8; location++) {
+            for (auto bit = 4; bit >= 0; bit--) {
+                putchar(screen.cgram[location * 8 + line] & (1 << bit) ? '#' : '.');
+            }
+
+            putchar(' ');
+        }
+
+        putchar('\n');
+    }
+}
+
+static int tty = -1;
+static struct termios cooked;
+
+static void restore() {
+    tcsetattr(tty, TCSANOW, &cooked);
+}
+
+int main(int argc, char *argv[]) {
+    bool quiet = false;
+    bool glyphs = false;
+    const char *path = "-";
+
+    for (auto i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-q") == 0) {
+            quiet = true;
+
+        } else if (strcmp(argv[i], "-g") == 0) {
+            glyphs = true;
+
+        } else {
+            path = argv[i];
+        }
+    }
+
+    FILE *in = strcmp(path, "-") == 0 ? stdin : fopen(path, "rb");
+
+    if (!in) {
+        fprintf(stderr, "%s: can't open\n", path);
+        return 2;
+    }
+
+    setvbuf(in, nullptr, _IONBF, 0); // live stream from a tty or pipe
+
+    // cooked mode would translate CR, eat ^C, ^D, DEL and wait for line ends
+    if (isatty(fileno(in)) && tcgetattr(fileno(in), &cooked) == 0) {
+        struct termios raw = cooked;
+        cfmakeraw(&raw);
+        raw.c_cc[VMIN] = 1;
+        raw.c_cc[VTIME] = 0;
+        tcsetattr(fileno(in), TCSANOW, &raw);
+        tty = fileno(in);
+        atexit(restore);
+    }
+
+    screen_t screen;
+    const uint8_t magic[] = {'T', 'D', 'M', 1};
+    size_t matched = 0;
+    int c;
+
+    // header: magic, columns, rows
+    while (matched < sizeof(magic) && (c = fgetc(in)) != EOF) {
+        matched = c == magic[matched] ? matched + 1 : (c == magic[0] ? 1 : 0);
+    }
+
+    int columns = fgetc(in);
+    int rows = fgetc(in);
+
+    if (matched < sizeof(magic) || columns <= 0 || rows <= 0 || columns * rows > 80) {
+        fprintf(stderr, "no mirror stream\n");
+        return 2;
+    }
+
+    screen.columns = columns;
+    screen.rows = rows;
+    memset(screen.cells, ' ', sizeof(screen.cells));
+    memset(screen.cgram, 0, sizeof(screen.cgram));
+    screen.bytes = sizeof(magic) + 2;
+
+    while ((c = fgetc(in)) != EOF) {
+        screen.bytes++;
+
+        if (c == MIRROR_END) {
+            screen.updates++;
+
+            if (!quiet) {
+                print(screen, glyphs);
+                fflush(stdout);
+            }
+
+            continue;
+        }
+
+        if ((c & 0xF8) == MIRROR_GLYPH) {
+            uint8_t *glyph = &screen.cgram[(c & 0b111) * 8];
+
+            if (fread(glyph, 1, 8, in) != 8) {
+                break;
+            }
+
+            screen.bytes += 8;
+            continue;
+        }
+
+        int len = fgetc(in);
+
+        if (len == EOF || c + len > screen.columns * screen.rows) {
+            fprintf(stderr, "corrupted stream at byte %lu\n", screen.bytes);
+            return 1;
+        }
+
+        if (fread(&screen.cells[c], 1, len, in) != (size_t)len) {
+            break;
+        }
+
+        screen.bytes += 1 + len;
+    }
+
+    if (quiet) {
+        print(screen, glyphs);
+    }
+
+    return 0;
+}
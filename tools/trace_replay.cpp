@@ -0,0 +1,402 @@
+/*
+MIT License
+Copyright (c) 2021 Pavel Slama
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/**
+ * Host tool, replays a trace recorded by DisplayBase::setTrace() into an HD44780 model
+ *
+ * Build: g++ -std=c++11 -O2 -o trace_replay trace_replay.cpp
+ * Usage: trace_replay trace.tdt [baseline.tdt [tolerance %]]
+ *
+ * Prints the bus statistics and the final screen. With a baseline the exit code is 1
+ * if the screen differs or pin changes, commands or time grew over the tolerance (5% by default)
+ *
+ * Times are taken when the library changes the pins, backends buffering them (I2C, SPI, MCP)
+ * send them later, so writes coming too early are meaningful for parallel bus only
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+enum trace_event_t { // same as DisplayBase
+    TRACE_DATA,
+    TRACE_EN,
+    TRACE_RS,
+    TRACE_RW,
+    TRACE_READ,
+    TRACE_BYTE
+};
+
+struct stats_t {
+    uint64_t time = 0; // us
+    uint64_t events = 0;
+    uint64_t pin_changes = 0;
+    uint64_t pulses = 0;
+    uint64_t commands = 0;
+    uint64_t data = 0;
+    uint64_t reads = 0;
+    uint64_t busy_polls = 0;
+    uint64_t violations = 0; // written while still executing
+};
+
+class Controller {
+  public:
+    stats_t stats;
+
+    Controller() {
+        memset(_ddram, ' ', sizeof(_ddram));
+        memset(_cgram, 0, sizeof(_cgram));
+    }
+
+    void event(uint8_t type, uint8_t value, uint64_t now) {
+        _now = now;
+
+        switch (type) {
+            case TRACE_DATA:
+                _pins = value;
+                stats.pin_changes++;
+                break;
+
+            case TRACE_RS:
+                _rs = value;
+                stats.pin_changes++;
+                break;
+
+            case TRACE_RW:
+                _rw = value;
+                _half = false;
+                stats.pin_changes++;
+                break;
+
+            case TRACE_EN:
+                stats.pin_changes++;
+
+                if (_en && !value && !_rw) {
+                    stats.pulses++;
+                    latch();
+                }
+
+                if (!_en && value && _rw) {
+                    read();
+                }
+
+                _en = value;
+                break;
+
+            case TRACE_READ:
+                break;
+
+            case TRACE_BYTE: // native interface, bus paces itself
+                execute(_rs, value, false);
+                break;
+        }
+    }
+
+    std::string line(uint8_t address, uint8_t columns) {
+        std::string text;
+
+        for (auto i = 0; i < columns; i++) {
+            uint8_t column = ((address & 0x3F) + i - _shift % 40 + 40) % 40;
+            char c = _ddram[(address & 0x40) + column];
+            text += (c < 0x20 || c > 0x7E) ? '.' : c; // CGRAM and ROM specific codes
+        }
+
+        return text;
+    }
+
+  private:
+    uint8_t _ddram[0x80];
+    uint8_t _cgram[64];
+    uint8_t _ac = 0;
+    bool _cg = false;
+    bool _increment = true;
+    bool _shift_entry = false;
+    int _shift = 0;
+    bool _four = false; // powers up in 8-bit mode
+    bool _half = false;
+    uint8_t _high = 0;
+    uint8_t _pins = 0;
+    bool _rs = false, _rw = false, _en = false;
+    uint64_t _now = 0;
+    uint64_t _busy_until = 0;
+
+    void latch() {
+        if (!_four) {
+            execute(_rs, _pins << 4, true);
+            return;
+        }
+
+        if (!_half) {
+            _high = _pins;
+            _half = true;
+            return;
+        }
+
+        _half = false;
+        execute(_rs, _high << 4 | _pins, true);
+    }
+
+    void read() {
+        if (_half) { // second nibble
+            _half = false;
+            return;
+        }
+
+        _half = _four;
+
+        if (_rs) {
+            stats.reads++;
+            step();
+
+        } else {
+            stats.busy_polls++;
+        }
+    }
+
+    void step() {
+        if (_cg) {
+            _ac = (_ac + (_increment ? 1 : -1)) & 0x3F;
+            return;
+        }
+
+        if (_increment) {
+            _ac = _ac == 0x27 ? 0x40 : _ac == 0x67 ? 0 : _ac + 1;
+
+        } else {
+            _ac = _ac == 0x40 ? 0x27 : _ac == 0 ? 0x67 : _ac - 1;
+        }
+    }
+
+    void execute(bool data, uint8_t value, bool timed) {
+        if (timed && _now < _busy_until) {
+            stats.violations++;
+        }
+
+        uint64_t duration = 37;
+
+        if (data) {
+            stats.data++;
+
+            if (_cg) {
+                _cgram[_ac & 0x3F] = value;
+
+            } else {
+                _ddram[_ac & 0x7F] = value;
+            }
+
+            step();
+
+            if (_shift_entry) {
+                _shift += _increment ? -1 : 1;
+            }
+
+        } else {
+            stats.commands++;
+
+            if (value & 0x80) {
+                _ac = value & 0x7F;
+                _cg = false;
+
+            } else if (value & 0x40) {
+                _ac = value & 0x3F;
+                _cg = true;
+
+            } else if (value & 0x20) {
+                _four = !(value & 0x10);
+
+            } else if (value & 0x10) {
+                if ((value & 0b11) == 0b11) { // WS0010 mode/power
+
+                } else if (value & 0x08) {
+                    _shift += (value & 0x04) ? 1 : -1;
+
+                } else {
+                    bool increment = _increment;
+                    _increment = value & 0x04;
+                    step();
+                    _increment = increment;
+                }
+
+            } else if (value & 0x04 && !(value & 0x08)) {
+                _increment = value & 0x02;
+                _shift_entry = value & 0x01;
+
+            } else if (value == 0x02 || value == 0x03) {
+                _ac = 0;
+                _cg = false;
+                _shift = 0;
+                duration = 1520;
+
+            } else if (value == 0x01) {
+                memset(_ddram, ' ', sizeof(_ddram));
+                _ac = 0;
+                _cg = false;
+                _shift = 0;
+                _increment = true;
+                duration = 1520;
+            }
+        }
+
+        _busy_until = _now + duration;
+    }
+};
+
+struct replay_t {
+    stats_t stats;
+    std::vector<std::string> screen;
+    bool bf = false;
+};
+
+static bool replay(const char *path, replay_t *result) {
+    static const uint8_t rows[] = {2, 2, 2, 4, 2};
+    static const uint8_t columns[] = {8, 16, 20, 20, 40};
+    static const uint8_t lines[] = {0x00, 0x40, 0x14, 0x54};
+
+    FILE *file = fopen(path, "rb");
+    uint8_t header[6];
+
+    if (!file) {
+        fprintf(stderr, "%s: can't open\n", path);
+        return false;
+    }
+
+    if (fread(header, 1, sizeof(header), file) != sizeof(header) || memcmp(header, "TDT", 3) != 0 ||
+            header[3] != 1 || header[4] > 4) {
+        fprintf(stderr, "%s: not a trace\n", path);
+        fclose(file);
+        return false;
+    }
+
+    Controller lcd;
+    uint64_t now = 0;
+    int c;
+
+    while ((c = fgetc(file)) != EOF) {
+        uint8_t type = c >> 4;
+        uint8_t value = c & 0b1111;
+        uint32_t delta = 0;
+        int shift = 0;
+
+        if (type == TRACE_BYTE) {
+            c = fgetc(file);
+            value = c;
+        }
+
+        do {
+            c = fgetc(file);
+            delta |= (uint32_t)(c & 0x7F) << shift;
+            shift += 7;
+        } while (c != EOF && (c & 0x80));
+
+        if (c == EOF) {
+            fprintf(stderr, "%s: truncated\n", path);
+            break;
+        }
+
+        now += delta;
+        lcd.stats.events++;
+        lcd.event(type, value, now);
+    }
+
+    fclose(file);
+
+    lcd.stats.time = now;
+    result->stats = lcd.stats;
+    result->bf = header[5];
+
+    for (auto row = 0; row < rows[header[4]]; row++) {
+        result->screen.push_back(lcd.line(lines[row], columns[header[4]]));
+    }
+
+    return true;
+}
+
+static void print(const replay_t &r) {
+    printf("time        %llu us\n", (unsigned long long)r.stats.time);
+    printf("events      %llu\n", (unsigned long long)r.stats.events);
+    printf("pin changes %llu\n", (unsigned long long)r.stats.pin_changes);
+    printf("E pulses    %llu\n", (unsigned long long)r.stats.pulses);
+    printf("commands    %llu\n", (unsigned long long)r.stats.commands);
+    printf("data        %llu\n", (unsigned long long)r.stats.data);
+    printf("reads       %llu\n", (unsigned long long)r.stats.reads);
+    printf("busy polls  %llu\n", (unsigned long long)r.stats.busy_polls);
+
+    if (!r.bf) { // busy flag traces poll instead of waiting
+        printf("too early   %llu\n", (unsigned long long)r.stats.violations);
+    }
+
+    for (auto &line : r.screen) {
+        printf("|%s|\n", line.c_str());
+    }
+}
+
+static bool grown(const char *name, uint64_t value, uint64_t baseline, double tolerance) {
+    double change = baseline ? 100.0 * ((double)value - baseline) / baseline : (value ? 100.0 : 0.0);
+    bool over = change > tolerance;
+
+    printf("%-12s %10llu %10llu %+7.1f%%%s\n", name, (unsigned long long)value, (unsigned long long)baseline,
+           change, over ? "  <-- regression" : "");
+
+    return over;
+}
+
+int main(int argc, char *argv[]) {
+    replay_t trace;
+    replay_t baseline;
+    double tolerance = argc > 3 ? atof(argv[3]) : 5.0;
+
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s trace.tdt [baseline.tdt [tolerance %%]]\n", argv[0]);
+        return 2;
+    }
+
+    if (!replay(argv[1], &trace)) {
+        return 2;
+    }
+
+    print(trace);
+
+    if (argc < 3) {
+        return 0;
+    }
+
+    if (!replay(argv[2], &baseline)) {
+        return 2;
+    }
+
+    bool failed = false;
+
+    printf("\n%-12s %10s %10s\n", "", "trace", "baseline");
+    failed |= grown("time", trace.stats.time, baseline.stats.time, tolerance);
+    failed |= grown("pin changes", trace.stats.pin_changes, baseline.stats.pin_changes, tolerance);
+    failed |= grown("commands", trace.stats.commands, baseline.stats.commands, tolerance);
+    failed |= grown("data", trace.stats.data, baseline.stats.data, tolerance);
+    failed |= grown("too early", trace.stats.violations, baseline.stats.violations, 0);
+
+    if (trace.screen != baseline.screen) {
+        printf("screen differs\n");
+        failed = true;
+    }
+
+    return failed ? 1 : 0;
+}